@@ -0,0 +1,56 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+size_t
+gmpmee_array_export(void *rop, mpz_t *op, size_t len, size_t size,
+		    int endian)
+{
+  size_t i;
+  size_t bytes;
+  unsigned char *p = (unsigned char *)rop;
+
+  for (i = 0; i < len; i++)
+    {
+      /* Stop at the first integer that is negative or does not fit
+         in size bytes. */
+      bytes = (mpz_sizeinbase(op[i], 2) + 7) / 8;
+      if (mpz_sgn(op[i]) < 0 || bytes > size)
+	{
+	  break;
+	}
+
+      /* Pad with zeros at the most significant end. Note that
+         mpz_export writes nothing at all for zero. */
+      memset(p, 0, size);
+      if (endian == GMPMEE_BIG_ENDIAN)
+	{
+	  mpz_export(p + size - bytes, NULL, 1, 1, 0, 0, op[i]);
+	}
+      else
+	{
+	  mpz_export(p, NULL, -1, 1, 0, 0, op[i]);
+	}
+      p += size;
+    }
+  return i;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+size_t
+gmpmee_array_fread(mpz_t *rop, size_t len, size_t size, int endian,
+		   FILE *stream)
+{
+  size_t i;
+  size_t chunk_len;
+  size_t read_len;
+  unsigned char *buf;
+
+  /* Integers of zero bytes can not be read. */
+  if (size == 0)
+    {
+      return 0;
+    }
+
+  /* Read the file in chunks of a bounded number of bytes. */
+  chunk_len = GMPMEE_ARRAY_CHUNK_BYTES / size;
+  if (chunk_len == 0)
+    {
+      chunk_len = 1;
+    }
+  buf = (unsigned char *)malloc(chunk_len * size);
+
+  i = 0;
+  while (i < len)
+    {
+      if (len - i < chunk_len)
+	{
+	  chunk_len = len - i;
+	}
+
+      read_len = fread(buf, size, chunk_len, stream);
+      gmpmee_array_import(rop + i, read_len, buf, size, endian);
+      i += read_len;
+
+      if (read_len < chunk_len)
+	{
+	  break;
+	}
+    }
+
+  free(buf);
+  return i;
+}
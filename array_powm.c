@@ -0,0 +1,92 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Computes the exponentiations in groups of the given number of
+ * lanes with the same modulus in all lanes, and returns the number
+ * of exponentiations computed. The computation stops at a final
+ * group with too few exponents for the kernel to pay off, or if
+ * memory for the kernel can not be allocated.
+ */
+static size_t
+array_lanes(mpz_t *rops, mpz_t *bases, mpz_t *exps, size_t len,
+	    mpz_t modulus, unsigned int lanes)
+{
+  size_t i;
+  size_t group;
+  size_t bitlen = mpz_sizeinbase(modulus, 2);
+  gmpmee_lanes_mont mont;
+  mpz_t moduli[1];
+
+  /* The same modulus is used in all lanes. A read-only alias of the
+     modulus is an array of moduli without copying the limbs, and it
+     is not cleared. */
+  mpz_roinit_n(moduli[0], mpz_limbs_read(modulus), mpz_size(modulus));
+  if (!gmpmee_lanes_mont_init(mont, moduli, 1, lanes))
+    {
+      return 0;
+    }
+  for (i = 0; i < len; i += group)
+    {
+      group = len - i < lanes ? len - i : lanes;
+      if (gmpmee_lanes_select_batch(bitlen, group) != lanes
+	  || !gmpmee_lanes_mont_powm(mont, rops + i, bases + i, exps + i,
+				     group))
+	{
+	  break;
+	}
+    }
+  gmpmee_lanes_mont_clear(mont);
+  return i;
+}
+
+void
+gmpmee_array_powm(mpz_t *rops, mpz_t *bases, mpz_t *exps, size_t len,
+		  mpz_t modulus)
+{
+  size_t i = 0;
+  unsigned int lanes = 0;
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_ARRAY_POWM,
+				  modulus, exps, len);
+
+  /* The kernels require an odd modulus. */
+  if (mpz_odd_p(modulus) && mpz_cmp_ui(modulus, 1) > 0)
+    {
+      lanes = gmpmee_lanes_select_batch(mpz_sizeinbase(modulus, 2), len);
+    }
+
+  if (lanes > 0)
+    {
+      i = array_lanes(rops, bases, exps, len, modulus, lanes);
+    }
+  for (; i < len; i++)
+    {
+      mpz_powm(rops[i], bases[i], exps[i], modulus);
+      GMPMEE_STATS_INC(powm);
+    }
+
+  if (traced)
+    {
+      gmpmee_trace_leave(record);
+    }
+}
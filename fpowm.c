@@ -17,84 +17,116 @@
  * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
 #include <gmp.h>
 #include "gmpmee.h"
 
-/*
- * Let op = (x_0,..,x_t), where x_i is a binary string with stretch
- * number of bits (except that x_t may have more bits) and
- * t=block_width. This function returns (x_{0,i},...,x_{t,i}), where
- * x_{j,i} is the ith bit of x_j. Each x_j except x_t is considered as
- * padded with zeros if i > stretch is asked for.
- *
- * @param op Integer from which bits are derived.
- * @param index Bit index in each sequence of stretch (or more) bits.
- * @param block_width Number of integers considered in parallel.
- * @param stretch Number of bits in each integer.
- */
-static int
-getbits(mpz_t op, int index, size_t block_width, size_t stretch)
+static void
+fpowm(mpz_t rop, gmpmee_fpowm_tab table, mpz_t exponent)
 {
-  int i;
-  int bits = 0;
+  int index;
+  int mask;
+  size_t block_width = table->spowm_table->block_width;
+  mpz_t **tabs = table->spowm_table->tabs;
 
-  if (((size_t) index) < stretch)
-    {
-      for (i = block_width - 1; i >= 0; i--)
-	{
-	  bits <<= 1;
-	  if (mpz_tstbit(op, i * stretch + index))
-	    {
-	      bits |= 1;
-	    }
-	}
-      return bits;
+  mpz_set_ui(rop, 1);
 
-    }
-  else
+  /* Execute square-and-multiply. */
+  for (index = gmpmee_fpowm_steps(exponent, block_width, table->stretch) - 1;
+       index >= 0; index--)
     {
-      if (mpz_tstbit(op, (block_width - 1) * stretch + index)) {
-	bits |= 1;
-	bits <<= (block_width - 1);
-      }
-      return bits;
+
+      /* Square ... */
+      mpz_mul(rop, rop, rop);
+      mpz_mod(rop, rop, table->spowm_table->modulus);
+      GMPMEE_STATS_INC(sqr);
+      GMPMEE_STATS_INC(redc);
+
+      /* and multiply */
+      mask = gmpmee_fpowm_getbits(exponent, index, block_width,
+				  table->stretch);
+      mpz_mul(rop, rop, tabs[0][mask]);
+      mpz_mod(rop, rop, table->spowm_table->modulus);
+      GMPMEE_STATS_INC(mul);
+      GMPMEE_STATS_INC(redc);
 
     }
 }
 
-void
-gmpmee_fpowm(mpz_t rop, gmpmee_fpowm_tab table, mpz_t exponent)
+/*
+ * Same as fpowm, but computed in Montgomery representation by the
+ * Montgomery kernels using the Montgomery table. The temporary space
+ * is local, so a table may be used by several threads.
+ */
+static void
+fpowm_mont(mpz_t rop, gmpmee_fpowm_tab table, mpz_t exponent)
 {
   int index;
   int mask;
-  size_t max_exponent_bitlen;
   size_t block_width = table->spowm_table->block_width;
-  mpz_t **tabs = table->spowm_table->tabs;
+  const mp_limb_t *mtab = table->spowm_table->mtabs;
+  const mp_limb_t *mp = table->spowm_table->mont->mp;
+  mp_size_t n = table->spowm_table->mont->size;
+  mp_limb_t minv = table->spowm_table->mont->minv;
+  mp_limb_t *yp;
+  mp_limb_t *tp;
+  mp_limb_t *rp;
 
+  yp = (mp_limb_t *)malloc(3 * n * sizeof(mp_limb_t));
+  tp = yp + n;
+  mpn_copyi(yp, table->spowm_table->mont->one, n);
 
-  /* Compute the maximal bit length among the exponents. */
-  max_exponent_bitlen = mpz_sizeinbase(exponent, 2);
-  if (max_exponent_bitlen < block_width * table->stretch) {
-    max_exponent_bitlen = table->stretch;
-  } else {
-    max_exponent_bitlen -= (block_width - 1) * table->stretch;
-  }
+  for (index = gmpmee_fpowm_steps(exponent, block_width, table->stretch) - 1;
+       index >= 0; index--)
+    {
+      gmpmee_kernels->sqr(yp, yp, mp, n, minv, tp);
+      GMPMEE_STATS_INC(sqr);
+      GMPMEE_STATS_INC(redc);
 
+      mask = gmpmee_fpowm_getbits(exponent, index, block_width,
+				  table->stretch);
+      gmpmee_kernels->mul(yp, yp, mtab + mask * n, mp, n, minv, tp);
+      GMPMEE_STATS_INC(mul);
+      GMPMEE_STATS_INC(redc);
+    }
 
-  mpz_set_ui(rop, 1);
+  /* Reduce y padded with zeros, i.e., multiply by 1/R. */
+  mpn_zero(tp + n, n);
+  mpn_copyi(tp, yp, n);
+  rp = mpz_limbs_write(rop, n);
+  gmpmee_kernels->redc(rp, tp, mp, n, minv);
+  mpz_limbs_finish(rop, n);
+  GMPMEE_STATS_INC(redc);
 
-  /* Execute square-and-multiply. */
-  for (index = max_exponent_bitlen - 1; index >= 0; index--)
-    {
+  free(yp);
+}
 
-      /* Square ... */
-      mpz_mul(rop, rop, rop);
-      mpz_mod(rop, rop, table->spowm_table->modulus);
+void
+gmpmee_fpowm(mpz_t rop, gmpmee_fpowm_tab table, mpz_t exponent)
+{
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_FPOWM,
+				  table->spowm_table->modulus, NULL, 1);
 
-      /* and multiply */
-      mask = getbits(exponent, index, block_width, table->stretch);
-      mpz_mul(rop, rop, tabs[0][mask]);
-      mpz_mod(rop, rop, table->spowm_table->modulus);
+  /* The destination may be the exponent. */
+  if (traced)
+    {
+      record->exponent_bitlen = mpz_sizeinbase(exponent, 2);
+    }
+
+  if (table->spowm_table->mtabs != NULL)
+    {
+      GMPMEE_STATS_TIME(eval_seconds, fpowm_mont(rop, table, exponent));
+    }
+  else
+    {
+      GMPMEE_STATS_TIME(eval_seconds, fpowm(rop, table, exponent));
+    }
 
+  if (traced)
+    {
+      record->block_width = table->spowm_table->block_width;
+      record->batch_len = table->stretch * record->block_width;
+      gmpmee_trace_leave(record);
     }
 }
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Sets rops[l] to entry e + l of the Montgomery table of the table
+ * for 0 <= l < count, using the given temporary space of twice the
+ * size of the modulus in limbs. The context of the table is not
+ * modified, so the table may be used by several threads.
+ */
+static void
+entries_from_mont(mpz_t *rops, gmpmee_spowm_tab table, size_t e,
+		  unsigned int count, mp_limb_t *tp)
+{
+  unsigned int l;
+  mp_size_t n = table->mont->size;
+  mp_limb_t *rp;
+
+  for (l = 0; l < count; l++)
+    {
+      /* Reduce the entry padded with zeros, i.e., multiply by 1/R. */
+      mpn_copyi(tp, table->mtabs + (e + l) * n, n);
+      mpn_zero(tp + n, n);
+      rp = mpz_limbs_write(rops[l], n);
+      gmpmee_kernels->redc(rp, tp, table->mont->mp, n, table->mont->minv);
+      mpz_limbs_finish(rops[l], n);
+      GMPMEE_STATS_INC(redc);
+    }
+}
+
+/*
+ * Computes the exponentiations in groups of the given number of
+ * lanes and returns the number of exponentiations computed. Every
+ * entry of the Montgomery table is converted to the representation
+ * of the kernel once and kept as a single lane of digits, from
+ * which each lane picks its own entry in each step. The computation
+ * stops at a final group with too few exponents for the kernel to
+ * pay off, or immediately if memory for the kernel can not be
+ * allocated. Lanes with shorter exponents multiply by the entry of
+ * the empty subset, i.e., one, in the leading steps, so the results
+ * are identical to those of gmpmee_fpowm.
+ */
+static size_t
+fpowm_lanes(mpz_t *rops, gmpmee_fpowm_tab table, mpz_t *exponents,
+	    size_t len, unsigned int lanes)
+{
+  size_t j;
+  size_t e;
+  size_t g;
+  size_t group;
+  size_t max_steps;
+  int index;
+  unsigned int l;
+  unsigned int count;
+  gmpmee_lanes_mont mont;
+  uint64_t *digits;
+  uint64_t *x;
+  uint64_t *y;
+  size_t n;
+  size_t block_width = table->spowm_table->block_width;
+  size_t stretch = table->stretch;
+  size_t entries = (size_t)1 << block_width;
+  size_t bitlen = mpz_sizeinbase(table->spowm_table->modulus, 2);
+  mpz_t *ops;
+  mp_limb_t *tp;
+
+  if (!gmpmee_lanes_mont_init(mont, &table->spowm_table->modulus, 1,
+			      lanes))
+    {
+      return 0;
+    }
+  n = mont->n;
+  x = gmpmee_lanes_alloc(mont->size);
+  y = gmpmee_lanes_alloc(mont->size);
+  digits = gmpmee_lanes_alloc(entries * n);
+  tp = (mp_limb_t *)
+    malloc(2 * table->spowm_table->mont->size * sizeof(mp_limb_t));
+  if (x == NULL || y == NULL || digits == NULL || tp == NULL)
+    {
+      free(tp);
+      gmpmee_lanes_free(digits);
+      gmpmee_lanes_free(y);
+      gmpmee_lanes_free(x);
+      gmpmee_lanes_mont_clear(mont);
+      return 0;
+    }
+
+  ops = gmpmee_array_alloc_init(lanes);
+  for (e = 0; e < entries; e += lanes)
+    {
+      count = entries - e < lanes ? entries - e : lanes;
+      entries_from_mont(ops, table->spowm_table, e, count, tp);
+      gmpmee_lanes_mont_to(mont, x, ops, count);
+      for (l = 0; l < count; l++)
+	{
+	  for (j = 0; j < n; j++)
+	    {
+	      digits[(e + l) * n + j] = x[j * lanes + l];
+	    }
+	}
+    }
+  gmpmee_array_clear_dealloc(ops, lanes);
+  free(tp);
+
+  for (g = 0; g < len; g += group)
+    {
+      group = len - g < lanes ? len - g : lanes;
+
+      if (gmpmee_lanes_select_batch(bitlen, group) != lanes)
+	{
+	  break;
+	}
+
+      max_steps = 0;
+      for (l = 0; l < group; l++)
+	{
+	  e = gmpmee_fpowm_steps(exponents[g + l], block_width, stretch);
+	  if (e > max_steps)
+	    {
+	      max_steps = e;
+	    }
+	}
+
+      /* R mod m in every lane. */
+      gmpmee_lanes_mont_mul(mont, y, mont->r2, mont->unit);
+
+      for (index = max_steps - 1; index >= 0; index--)
+	{
+	  gmpmee_lanes_mont_sqr(mont, y, y);
+
+	  for (l = 0; l < lanes; l++)
+	    {
+	      e = l < group ?
+		gmpmee_fpowm_getbits(exponents[g + l], index, block_width,
+				     stretch) : 0;
+	      for (j = 0; j < n; j++)
+		{
+		  x[j * lanes + l] = digits[e * n + j];
+		}
+	    }
+	  gmpmee_lanes_mont_mul(mont, y, y, x);
+	}
+
+      gmpmee_lanes_mont_from(mont, rops + g, y, group);
+    }
+
+  gmpmee_lanes_free(digits);
+  gmpmee_lanes_free(y);
+  gmpmee_lanes_free(x);
+  gmpmee_lanes_mont_clear(mont);
+
+  return g;
+}
+
+void
+gmpmee_fpowm_batch(mpz_t *rops, gmpmee_fpowm_tab table, mpz_t *exponents,
+		   size_t len)
+{
+  size_t i = 0;
+  unsigned int lanes = 0;
+  mpz_t *modulus = &table->spowm_table->modulus;
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_FPOWM_BATCH,
+				  *modulus, exponents, len);
+
+  /* The kernels require an odd modulus. */
+  if (mpz_odd_p(*modulus) && mpz_cmp_ui(*modulus, 1) > 0)
+    {
+      lanes = gmpmee_lanes_select_batch(mpz_sizeinbase(*modulus, 2), len);
+    }
+
+  if (lanes > 0)
+    {
+      GMPMEE_STATS_TIME(eval_seconds,
+			i = fpowm_lanes(rops, table, exponents, len, lanes));
+    }
+  for (; i < len; i++)
+    {
+      gmpmee_fpowm(rops[i], table, exponents[i]);
+    }
+
+  if (traced)
+    {
+      record->block_width = table->spowm_table->block_width;
+      record->batch_len = table->stretch * record->block_width;
+      gmpmee_trace_leave(record);
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_fpowm_getbits(mpz_t op, int index, size_t block_width,
+		     size_t stretch)
+{
+  int i;
+  int bits = 0;
+
+  if (((size_t) index) < stretch)
+    {
+      for (i = block_width - 1; i >= 0; i--)
+	{
+	  bits <<= 1;
+	  if (mpz_tstbit(op, i * stretch + index))
+	    {
+	      bits |= 1;
+	    }
+	}
+      return bits;
+
+    }
+  else
+    {
+      if (mpz_tstbit(op, (block_width - 1) * stretch + index)) {
+	bits |= 1;
+	bits <<= (block_width - 1);
+      }
+      return bits;
+
+    }
+}
@@ -20,12 +20,48 @@
 #include <gmp.h>
 #include "gmpmee.h"
 
+/*
+ * Sets bases[i] = bases[i - 1]^eb mod modulus for 0 < i < len.
+ */
+static void
+powers(mpz_t *bases, size_t len, mpz_t eb, mpz_t modulus)
+{
+  size_t i;
+
+  for (i = 1; i < len; i++) {
+    mpz_powm(bases[i], bases[i - 1], eb, modulus);
+    GMPMEE_STATS_INC(powm);
+  }
+}
+
+/*
+ * Same as powers, but computed by repeated squaring in Montgomery
+ * representation using the Montgomery kernels, where eb = 2^stretch.
+ */
+static void
+powers_mont(mpz_t *bases, size_t len, size_t stretch, gmpmee_mont mont)
+{
+  size_t i, j;
+
+  gmpmee_mont_to(mont->xp, bases[0], mont);
+  for (i = 1; i < len; i++)
+    {
+      for (j = 0; j < stretch; j++)
+        {
+          gmpmee_mont_sqr(mont->xp, mont->xp, mont);
+        }
+      gmpmee_mont_from(bases[i], mont->xp, mont);
+    }
+}
+
 void
 gmpmee_fpowm_precomp(gmpmee_fpowm_tab table, mpz_t basis)
 {
-  size_t i;
   size_t block_width = table->spowm_table->block_width;
   mpz_t *bases = gmpmee_array_alloc_init(block_width);
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_FPOWM_PRECOMP,
+				  table->spowm_table->modulus, NULL, 1);
 
   mpz_t eb;
 
@@ -34,12 +70,28 @@ gmpmee_fpowm_precomp(gmpmee_fpowm_tab table, mpz_t basis)
   mpz_setbit(eb, table->stretch);
 
   mpz_set(bases[0], basis);
-  for (i = 1; i < block_width; i++) {
-    mpz_powm(bases[i], bases[i - 1], eb, table->spowm_table->modulus);
-  }
+  if (table->spowm_table->mtabs != NULL)
+    {
+      GMPMEE_STATS_TIME(precomp_seconds,
+			powers_mont(bases, block_width, table->stretch,
+				    table->spowm_table->mont));
+    }
+  else
+    {
+      GMPMEE_STATS_TIME(precomp_seconds,
+			powers(bases, block_width, eb,
+			       table->spowm_table->modulus));
+    }
 
   gmpmee_spowm_precomp(table->spowm_table, bases);
 
   mpz_clear(eb);
   gmpmee_array_clear_dealloc(bases, block_width);
+
+  if (traced)
+    {
+      record->block_width = block_width;
+      record->batch_len = table->stretch * block_width;
+      gmpmee_trace_leave(record);
+    }
 }
@@ -0,0 +1,1152 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Benchmark suite of GMPMEE. Each operation is executed repeatedly
+ * with fixed random inputs until a minimal running time has passed,
+ * and the number of operations per second and the number of cycles
+ * per operation are reported as a table, as JSON, or as CSV. The
+ * routines of GMPMEE are compared with the naive and GMP-based
+ * routines that they replace. Optionally, the speedups are checked
+ * against thresholds and the results against a baseline, and the
+ * exit status indicates if the checks passed. On Linux, hardware
+ * performance counters may also be read around each operation.
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+#if defined(__linux__)
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define BENCH_HAVE_PERF 1
+#endif
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Largest number of values in a comma-separated list of options.
+ */
+#define BENCH_MAX_LIST 32
+
+/*
+ * Largest number of results kept for checking thresholds and
+ * baselines.
+ */
+#define BENCH_MAX_RESULTS 1024
+
+/*
+ * Length of buffers holding names of suites and operations.
+ */
+#define BENCH_NAME_LEN 64
+
+/*
+ * Number of hardware performance counters.
+ */
+#define BENCH_PERF_EVENTS 5
+
+/*
+ * Names of the hardware performance counters.
+ */
+static const char *perf_names[BENCH_PERF_EVENTS] =
+  {"hw_cycles", "instructions", "l1d_misses", "llc_misses",
+   "branch_misses"};
+
+/*
+ * Output formats.
+ */
+#define BENCH_TEXT 0
+#define BENCH_JSON 1
+#define BENCH_CSV 2
+
+/*
+ * Result of a single measurement.
+ */
+typedef struct
+{
+  const char *suite;       /* Name of the suite. */
+  const char *op;          /* Name of the operation. */
+  size_t modulus_bitlen;   /* Bit length of modulus or candidates. */
+  size_t exponent_bitlen;  /* Bit length of exponents, or zero. */
+  size_t param;            /* Block width, number of bases, or zero. */
+  unsigned long int ops;   /* Number of operations executed. */
+  double seconds;          /* Total running time. */
+  double cycles;           /* Total number of cycles, or negative. */
+  double perf[BENCH_PERF_EVENTS]; /* Totals of hardware counters, or
+				     negative if unavailable. */
+} bench_result;
+
+/*
+ * Options of a run of the benchmark.
+ */
+typedef struct
+{
+  size_t modulus_bitlens[BENCH_MAX_LIST];  /* Modulus bit lengths. */
+  size_t modulus_len;
+  size_t exponent_bitlens[BENCH_MAX_LIST]; /* Exponent bit lengths,
+					      where zero means the bit
+					      length of the modulus. */
+  size_t exponent_len;
+  size_t block_widths[BENCH_MAX_LIST];     /* Block widths. */
+  size_t block_len;
+  size_t safe_bitlens[BENCH_MAX_LIST];     /* Bit lengths of safe
+					      primes. */
+  size_t safe_len;
+  size_t bases;                            /* Number of bases. */
+  long ms;                                 /* Minimal time of each
+					      measurement. */
+  int format;                              /* Output format. */
+  const char *suites;                      /* Suites to run. */
+  unsigned long int seed;                  /* Seed of randomness. */
+  const char *thresholds;                  /* File of thresholds
+					      on speedups, or NULL. */
+  const char *baseline;                    /* Baseline in CSV
+					      format, or NULL. */
+  double tolerance;                        /* Smallest allowed
+					      fraction of baseline. */
+  int perf;                                /* Read hardware counters. */
+  int perf_fds[BENCH_PERF_EVENTS];         /* Descriptors of hardware
+					      counters, or -1. */
+  size_t results;                          /* Number of results. */
+  bench_result stored[BENCH_MAX_RESULTS];  /* Results. */
+} bench_options;
+
+
+/*
+ * Shared inputs of the operations.
+ */
+typedef struct
+{
+  gmp_randstate_t rstate;
+  mpz_t modulus;
+  mpz_t *bases;
+  mpz_t *exponents;
+  size_t len;
+  size_t bitlen;
+  size_t block_width;
+  gmpmee_fpowm_tab fpowm_table;
+  mpz_t rop;
+  mpz_t tmp;
+  int res;      /* Sink for results of tests, to keep them from
+		   being optimized away. */
+} bench_ctx;
+
+typedef void (*bench_fn)(bench_ctx *ctx);
+
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double
+cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+  return (double)__rdtsc();
+#else
+  return -1;
+#endif
+}
+
+/* #################### Hardware Counters #################### */
+
+/*
+ * Opens the hardware performance counters of the calling thread and
+ * returns the number of counters that are available. Counters that
+ * can not be opened, e.g., due to a virtual machine without a
+ * performance monitoring unit or a restrictive
+ * perf_event_paranoid, are simply reported as unavailable.
+ */
+static int
+perf_open(bench_options *opts)
+{
+  int i;
+  int available = 0;
+#ifdef BENCH_HAVE_PERF
+  struct perf_event_attr attr;
+  const uint32_t types[BENCH_PERF_EVENTS] =
+    {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+     PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+  const uint64_t configs[BENCH_PERF_EVENTS] =
+    {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+     PERF_COUNT_HW_CACHE_L1D
+     | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+  for (i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[i];
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+	| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      opts->perf_fds[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1,
+				       -1, 0);
+      if (opts->perf_fds[i] >= 0)
+	{
+	  available++;
+	}
+    }
+#else
+  for (i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+      opts->perf_fds[i] = -1;
+    }
+#endif
+  return available;
+}
+
+/*
+ * Resets and starts the available hardware counters.
+ */
+static void
+perf_start(bench_options *opts)
+{
+#ifdef BENCH_HAVE_PERF
+  int i;
+
+  for (i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+      if (opts->perf_fds[i] >= 0)
+	{
+	  ioctl(opts->perf_fds[i], PERF_EVENT_IOC_RESET, 0);
+	  ioctl(opts->perf_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+	}
+    }
+#else
+  GMPMEE_UNUSED(opts);
+#endif
+}
+
+/*
+ * Stops the hardware counters and stores their values, or a negative
+ * value for counters that are unavailable. Counters that were only
+ * scheduled part of the time, since there are more counters than
+ * registers, are scaled to the complete time.
+ */
+static void
+perf_stop(bench_options *opts, double *values)
+{
+  int i;
+#ifdef BENCH_HAVE_PERF
+  uint64_t buf[3];
+#endif
+
+  for (i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+      values[i] = -1;
+#ifdef BENCH_HAVE_PERF
+      if (opts->perf_fds[i] >= 0)
+	{
+	  ioctl(opts->perf_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+	  if (read(opts->perf_fds[i], buf, sizeof(buf)) == sizeof(buf)
+	      && buf[2] > 0)
+	    {
+	      values[i] = (double)buf[0] * buf[1] / buf[2];
+	    }
+	}
+#else
+      GMPMEE_UNUSED(opts);
+#endif
+    }
+}
+
+/*
+ * Closes the hardware counters.
+ */
+static void
+perf_close(bench_options *opts)
+{
+  int i;
+
+  for (i = 0; i < BENCH_PERF_EVENTS; i++)
+    {
+      if (opts->perf_fds[i] >= 0)
+	{
+	  close(opts->perf_fds[i]);
+	}
+    }
+}
+
+/* #################### Measurements #################### */
+
+/*
+ * Executes the operation until the minimal time has passed, with a
+ * doubling number of operations between reads of the clock, and
+ * prints the result.
+ */
+static void
+measure(FILE *out, bench_options *opts, bench_ctx *ctx, bench_fn fn,
+	const char *suite, const char *op, size_t modulus_bitlen,
+	size_t exponent_bitlen, size_t param)
+{
+  int j;
+  unsigned long int i;
+  unsigned long int batch = 1;
+  double start;
+  double start_cycles;
+  bench_result res;
+
+  res.suite = suite;
+  res.op = op;
+  res.modulus_bitlen = modulus_bitlen;
+  res.exponent_bitlen = exponent_bitlen;
+  res.param = param;
+  res.ops = 0;
+
+  /* One warm-up execution. */
+  fn(ctx);
+
+  if (opts->perf)
+    {
+      perf_start(opts);
+    }
+  start = now();
+  start_cycles = cycles();
+  do
+    {
+      for (i = 0; i < batch; i++)
+	{
+	  fn(ctx);
+	}
+      res.ops += batch;
+      batch *= 2;
+      res.seconds = now() - start;
+    }
+  while (res.seconds * 1000 < opts->ms);
+  res.cycles = start_cycles < 0 ? -1 : cycles() - start_cycles;
+  perf_stop(opts, res.perf);
+
+  if (opts->format == BENCH_JSON)
+    {
+      fprintf(out, "%s    {\"suite\": \"%s\", \"op\": \"%s\", "
+	      "\"modulus_bits\": %zu, \"exponent_bits\": %zu, "
+	      "\"param\": %zu, \"ops\": %lu, \"seconds\": %.6f, "
+	      "\"ops_per_sec\": %.3f, ",
+	      opts->results > 0 ? ",\n" : "",
+	      res.suite, res.op, res.modulus_bitlen, res.exponent_bitlen,
+	      res.param, res.ops, res.seconds, res.ops / res.seconds);
+      if (res.cycles < 0)
+	{
+	  fprintf(out, "\"cycles_per_op\": null");
+	}
+      else
+	{
+	  fprintf(out, "\"cycles_per_op\": %.0f", res.cycles / res.ops);
+	}
+      for (j = 0; opts->perf && j < BENCH_PERF_EVENTS; j++)
+	{
+	  if (res.perf[j] < 0)
+	    {
+	      fprintf(out, ", \"%s_per_op\": null", perf_names[j]);
+	    }
+	  else
+	    {
+	      fprintf(out, ", \"%s_per_op\": %.1f", perf_names[j],
+		      res.perf[j] / res.ops);
+	    }
+	}
+      fprintf(out, "}");
+    }
+  else if (opts->format == BENCH_CSV)
+    {
+      fprintf(out, "%s,%s,%zu,%zu,%zu,%lu,%.6f,%.3f,",
+	      res.suite, res.op, res.modulus_bitlen, res.exponent_bitlen,
+	      res.param, res.ops, res.seconds, res.ops / res.seconds);
+      if (res.cycles >= 0)
+	{
+	  fprintf(out, "%.0f", res.cycles / res.ops);
+	}
+      for (j = 0; opts->perf && j < BENCH_PERF_EVENTS; j++)
+	{
+	  fprintf(out, ",");
+	  if (res.perf[j] >= 0)
+	    {
+	      fprintf(out, "%.1f", res.perf[j] / res.ops);
+	    }
+	}
+      fprintf(out, "\n");
+    }
+  else
+    {
+      fprintf(out, "%-6s %-32s %6zu %6zu %6zu %14.3f",
+	      res.suite, res.op, res.modulus_bitlen, res.exponent_bitlen,
+	      res.param, res.ops / res.seconds);
+      if (res.cycles >= 0)
+	{
+	  fprintf(out, " %14.0f", res.cycles / res.ops);
+	}
+      else if (opts->perf)
+	{
+	  fprintf(out, " %14s", "-");
+	}
+      for (j = 0; opts->perf && j < BENCH_PERF_EVENTS; j++)
+	{
+	  if (res.perf[j] >= 0)
+	    {
+	      fprintf(out, " %14.1f", res.perf[j] / res.ops);
+	    }
+	  else
+	    {
+	      fprintf(out, " %14s", "-");
+	    }
+	}
+      fprintf(out, "\n");
+    }
+  if (opts->results < BENCH_MAX_RESULTS)
+    {
+      opts->stored[opts->results] = res;
+    }
+  opts->results++;
+  fflush(out);
+}
+
+/* #################### Gates #################### */
+
+/*
+ * Returns the number of operations per second of the stored result
+ * with the given operation and parameters, or a negative value if
+ * there is no such result.
+ */
+static double
+lookup(bench_options *opts, const char *op, size_t modulus_bitlen,
+       size_t exponent_bitlen, size_t param)
+{
+  size_t i;
+  bench_result *res;
+
+  for (i = 0; i < opts->results && i < BENCH_MAX_RESULTS; i++)
+    {
+      res = &opts->stored[i];
+      if (strcmp(res->op, op) == 0
+	  && res->modulus_bitlen == modulus_bitlen
+	  && res->exponent_bitlen == exponent_bitlen
+	  && res->param == param)
+	{
+	  return res->ops / res->seconds;
+	}
+    }
+  return -1;
+}
+
+/*
+ * Checks the speedups of operations relative to reference
+ * operations against the thresholds in the given file. Each line
+ * that is not empty or a comment is of the form
+ *
+ *   op param ref ref_param modulus_bits exponent_bits min_speedup
+ *
+ * A threshold of an operation that was not measured fails, since
+ * the file and the options do not match, and so does a file without
+ * any thresholds. Returns the number of failed thresholds, or -1 if
+ * the file can not be read.
+ */
+static int
+check_thresholds(bench_options *opts)
+{
+  int failed = 0;
+  int checked = 0;
+  char line[256];
+  char op[BENCH_NAME_LEN];
+  char ref[BENCH_NAME_LEN];
+  size_t param;
+  size_t ref_param;
+  size_t mbl;
+  size_t ebl;
+  double min_speedup;
+  double speed;
+  double ref_speed;
+  FILE *file;
+
+  if ((file = fopen(opts->thresholds, "r")) == NULL)
+    {
+      fprintf(stderr, "Unable to open %s!\n", opts->thresholds);
+      return -1;
+    }
+
+  while (fgets(line, sizeof(line), file) != NULL)
+    {
+      if (sscanf(line, "%63s %zu %63s %zu %zu %zu %lf", op, &param, ref,
+		 &ref_param, &mbl, &ebl, &min_speedup) != 7
+	  || op[0] == '#')
+	{
+	  continue;
+	}
+
+      checked++;
+      speed = lookup(opts, op, mbl, ebl, param);
+      ref_speed = lookup(opts, ref, mbl, ebl, ref_param);
+      if (speed < 0 || ref_speed < 0)
+	{
+	  fprintf(stderr, "FAIL %s(%zu)/%s(%zu) at %zu/%zu bits: "
+		  "not measured\n", op, param, ref, ref_param, mbl, ebl);
+	  failed++;
+	  continue;
+	}
+
+      if (speed / ref_speed < min_speedup)
+	{
+	  failed++;
+	}
+      fprintf(stderr, "%s %s(%zu)/%s(%zu) at %zu/%zu bits: "
+	      "speedup %.2f, required %.2f\n",
+	      speed / ref_speed < min_speedup ? "FAIL" : "PASS",
+	      op, param, ref, ref_param, mbl, ebl, speed / ref_speed,
+	      min_speedup);
+    }
+
+  fclose(file);
+
+  if (checked == 0)
+    {
+      fprintf(stderr, "FAIL no thresholds in %s!\n", opts->thresholds);
+      failed++;
+    }
+  return failed;
+}
+
+/*
+ * Checks the results against a baseline written in CSV format by a
+ * previous run on the same machine. A result fails if it is slower
+ * than the given fraction of the baseline. Returns the number of
+ * failed results, or -1 if the file can not be read.
+ */
+static int
+check_baseline(bench_options *opts)
+{
+  int failed = 0;
+  char line[512];
+  char suite[BENCH_NAME_LEN];
+  char op[BENCH_NAME_LEN];
+  size_t mbl;
+  size_t ebl;
+  size_t param;
+  unsigned long int ops;
+  double seconds;
+  double base_speed;
+  double speed;
+  FILE *file;
+
+  if ((file = fopen(opts->baseline, "r")) == NULL)
+    {
+      fprintf(stderr, "Unable to open %s!\n", opts->baseline);
+      return -1;
+    }
+
+  while (fgets(line, sizeof(line), file) != NULL)
+    {
+      if (sscanf(line, "%63[^,],%63[^,],%zu,%zu,%zu,%lu,%lf,%lf",
+		 suite, op, &mbl, &ebl, &param, &ops, &seconds,
+		 &base_speed) != 8)
+	{
+	  continue;
+	}
+
+      speed = lookup(opts, op, mbl, ebl, param);
+      if (speed < 0)
+	{
+	  continue;
+	}
+
+      if (speed < opts->tolerance * base_speed)
+	{
+	  failed++;
+	}
+      fprintf(stderr, "%s %s(%zu) at %zu/%zu bits: %.3f ops/sec, "
+	      "baseline %.3f\n",
+	      speed < opts->tolerance * base_speed ? "FAIL" : "PASS",
+	      op, param, mbl, ebl, speed, base_speed);
+    }
+
+  fclose(file);
+  return failed;
+}
+
+/* #################### Operations #################### */
+
+static void
+op_spowm(bench_ctx *ctx)
+{
+  gmpmee_spowm(ctx->rop, ctx->bases, ctx->exponents, ctx->len, ctx->modulus);
+}
+
+static void
+op_spowm_naive(bench_ctx *ctx)
+{
+  gmpmee_spowm_naive(ctx->rop, ctx->bases, ctx->exponents, ctx->len,
+		     ctx->modulus);
+}
+
+static void
+op_spowm_block_batch(bench_ctx *ctx)
+{
+  gmpmee_spowm_block_batch(ctx->rop, ctx->bases, ctx->exponents, ctx->len,
+			   ctx->modulus, ctx->block_width, ctx->len);
+}
+
+static void
+op_fpowm_precomp(bench_ctx *ctx)
+{
+  gmpmee_fpowm_tab table;
+
+  gmpmee_fpowm_init_precomp(table, ctx->bases[0], ctx->modulus,
+			    ctx->block_width, ctx->bitlen);
+  gmpmee_fpowm_clear(table);
+}
+
+static void
+op_fpowm(bench_ctx *ctx)
+{
+  gmpmee_fpowm(ctx->rop, ctx->fpowm_table, ctx->exponents[0]);
+}
+
+static void
+op_mpz_powm(bench_ctx *ctx)
+{
+  mpz_powm(ctx->rop, ctx->bases[0], ctx->exponents[0], ctx->modulus);
+}
+
+static void
+op_millerrabin_rs(bench_ctx *ctx)
+{
+  ctx->res += gmpmee_millerrabin_rs(ctx->rstate, ctx->modulus, 20);
+}
+
+static void
+op_millerrabin_bpsw_rs(bench_ctx *ctx)
+{
+  gmpmee_millerrabin_state state;
+
+  gmpmee_millerrabin_init(state, ctx->modulus);
+  ctx->res += gmpmee_millerrabin_bpsw_rs(ctx->rstate, state, 0);
+  gmpmee_millerrabin_clear(state);
+}
+
+static void
+op_mpz_probab_prime_p(bench_ctx *ctx)
+{
+  ctx->res += mpz_probab_prime_p(ctx->modulus, 20);
+}
+
+static void
+op_millerrabin_next_rs(bench_ctx *ctx)
+{
+  mpz_urandomb(ctx->tmp, ctx->rstate, ctx->bitlen);
+  mpz_setbit(ctx->tmp, ctx->bitlen - 1);
+  gmpmee_millerrabin_next_rs(ctx->rop, ctx->rstate, ctx->tmp, 20);
+}
+
+static void
+op_mpz_nextprime(bench_ctx *ctx)
+{
+  mpz_urandomb(ctx->tmp, ctx->rstate, ctx->bitlen);
+  mpz_setbit(ctx->tmp, ctx->bitlen - 1);
+  mpz_nextprime(ctx->rop, ctx->tmp);
+}
+
+static void
+op_millerrabin_safe_next_rs(bench_ctx *ctx)
+{
+  mpz_urandomb(ctx->tmp, ctx->rstate, ctx->bitlen);
+  mpz_setbit(ctx->tmp, ctx->bitlen - 1);
+  gmpmee_millerrabin_safe_next_rs(ctx->rop, ctx->rstate, ctx->tmp, 20);
+}
+
+static void
+op_random_safe_prime_rs(bench_ctx *ctx)
+{
+  gmpmee_random_safe_prime_rs(ctx->rop, ctx->rstate, ctx->bitlen, 20);
+}
+
+/* #################### Suites #################### */
+
+/*
+ * Sets the modulus to a random odd integer of the given bit length
+ * with the most significant bit set, and generates random bases and
+ * exponents.
+ */
+static void
+ctx_set(bench_ctx *ctx, size_t modulus_bitlen, size_t exponent_bitlen)
+{
+  size_t i;
+
+  mpz_urandomb(ctx->modulus, ctx->rstate, modulus_bitlen);
+  mpz_setbit(ctx->modulus, modulus_bitlen - 1);
+  mpz_setbit(ctx->modulus, 0);
+  for (i = 0; i < ctx->len; i++)
+    {
+      mpz_urandomm(ctx->bases[i], ctx->rstate, ctx->modulus);
+      mpz_urandomb(ctx->exponents[i], ctx->rstate, exponent_bitlen);
+    }
+  ctx->bitlen = exponent_bitlen;
+}
+
+static int
+selected(bench_options *opts, const char *suite)
+{
+  size_t len = strlen(suite);
+  const char *p = opts->suites;
+
+  while ((p = strstr(p, suite)) != NULL)
+    {
+      if ((p == opts->suites || p[-1] == ',')
+	  && (p[len] == '\0' || p[len] == ','))
+	{
+	  return 1;
+	}
+      p += len;
+    }
+  return 0;
+}
+
+static void
+suite_spowm(FILE *out, bench_options *opts, bench_ctx *ctx)
+{
+  size_t i;
+  size_t j;
+  size_t k;
+  size_t mbl;
+  size_t ebl;
+
+  for (i = 0; i < opts->modulus_len; i++)
+    {
+      for (j = 0; j < opts->exponent_len; j++)
+	{
+	  mbl = opts->modulus_bitlens[i];
+	  ebl = opts->exponent_bitlens[j] == 0 ? mbl : opts->exponent_bitlens[j];
+	  ctx_set(ctx, mbl, ebl);
+
+	  measure(out, opts, ctx, op_spowm, "spowm", "gmpmee_spowm",
+		  mbl, ebl, ctx->len);
+	  measure(out, opts, ctx, op_spowm_naive, "spowm",
+		  "gmpmee_spowm_naive", mbl, ebl, ctx->len);
+	  for (k = 0; k < opts->block_len; k++)
+	    {
+	      ctx->block_width = opts->block_widths[k];
+	      measure(out, opts, ctx, op_spowm_block_batch, "spowm",
+		      "gmpmee_spowm_block_batch", mbl, ebl, ctx->block_width);
+	    }
+	}
+    }
+}
+
+static void
+suite_fpowm(FILE *out, bench_options *opts, bench_ctx *ctx)
+{
+  size_t i;
+  size_t j;
+  size_t k;
+  size_t mbl;
+  size_t ebl;
+
+  for (i = 0; i < opts->modulus_len; i++)
+    {
+      for (j = 0; j < opts->exponent_len; j++)
+	{
+	  mbl = opts->modulus_bitlens[i];
+	  ebl = opts->exponent_bitlens[j] == 0 ? mbl : opts->exponent_bitlens[j];
+	  ctx_set(ctx, mbl, ebl);
+
+	  measure(out, opts, ctx, op_mpz_powm, "fpowm", "mpz_powm",
+		  mbl, ebl, 0);
+	  for (k = 0; k < opts->block_len; k++)
+	    {
+	      ctx->block_width = opts->block_widths[k];
+	      measure(out, opts, ctx, op_fpowm_precomp, "fpowm",
+		      "gmpmee_fpowm_precomp", mbl, ebl, ctx->block_width);
+
+	      gmpmee_fpowm_init_precomp(ctx->fpowm_table, ctx->bases[0],
+					ctx->modulus, ctx->block_width, ebl);
+	      measure(out, opts, ctx, op_fpowm, "fpowm", "gmpmee_fpowm",
+		      mbl, ebl, ctx->block_width);
+	      gmpmee_fpowm_clear(ctx->fpowm_table);
+	    }
+	}
+    }
+}
+
+static void
+suite_mr(FILE *out, bench_options *opts, bench_ctx *ctx)
+{
+  size_t i;
+  size_t mbl;
+
+  for (i = 0; i < opts->modulus_len; i++)
+    {
+      mbl = opts->modulus_bitlens[i];
+
+      /* Testing a prime is the worst case. */
+      mpz_urandomb(ctx->tmp, ctx->rstate, mbl);
+      mpz_setbit(ctx->tmp, mbl - 1);
+      mpz_nextprime(ctx->modulus, ctx->tmp);
+      ctx->bitlen = mbl;
+
+      measure(out, opts, ctx, op_millerrabin_rs, "mr",
+	      "gmpmee_millerrabin_rs", mbl, 0, 20);
+      measure(out, opts, ctx, op_millerrabin_bpsw_rs, "mr",
+	      "gmpmee_millerrabin_bpsw_rs", mbl, 0, 0);
+      measure(out, opts, ctx, op_mpz_probab_prime_p, "mr",
+	      "mpz_probab_prime_p", mbl, 0, 20);
+      measure(out, opts, ctx, op_millerrabin_next_rs, "mr",
+	      "gmpmee_millerrabin_next_rs", mbl, 0, 20);
+      measure(out, opts, ctx, op_mpz_nextprime, "mr", "mpz_nextprime",
+	      mbl, 0, 0);
+    }
+}
+
+static void
+suite_safe(FILE *out, bench_options *opts, bench_ctx *ctx)
+{
+  size_t i;
+  size_t bl;
+
+  for (i = 0; i < opts->safe_len; i++)
+    {
+      bl = opts->safe_bitlens[i];
+      ctx->bitlen = bl;
+      measure(out, opts, ctx, op_millerrabin_safe_next_rs, "safe",
+	      "gmpmee_millerrabin_safe_next_rs", bl, 0, 20);
+      measure(out, opts, ctx, op_random_safe_prime_rs, "safe",
+	      "gmpmee_random_safe_prime_rs", bl, 0, 20);
+    }
+}
+
+/* #################### Driver #################### */
+
+/*
+ * Parses a comma-separated list of positive integers, or zero if
+ * zero is allowed. Returns the number of integers, or zero on error.
+ */
+static size_t
+parse_list(size_t *list, const char *str, int zero)
+{
+  size_t len = 0;
+  char *end;
+  unsigned long int v;
+
+  for (;;)
+    {
+      v = strtoul(str, &end, 10);
+      if (end == str || (v == 0 && !zero) || len == BENCH_MAX_LIST)
+	{
+	  return 0;
+	}
+      list[len++] = v;
+      if (*end == '\0')
+	{
+	  return len;
+	}
+      if (*end != ',')
+	{
+	  return 0;
+	}
+      str = end + 1;
+    }
+}
+
+static void
+usage(char *command_name)
+{
+  printf("Usage: %s [options]\n\n"
+	 "  -m <list>   Modulus bit lengths (default 1024,2048,3072).\n"
+	 "  -e <list>   Exponent bit lengths, where 0 means the bit length\n"
+	 "              of the modulus (default 256,0).\n"
+	 "  -w <list>   Block widths of spowm_block_batch and fpowm\n"
+	 "              (default 2,4,6,8,10).\n"
+	 "  -S <list>   Bit lengths of safe primes (default 256,512).\n"
+	 "  -n <int>    Number of bases of simultaneous\n"
+	 "              exponentiations (default 100).\n"
+	 "  -t <ms>     Minimal time of each measurement (default 500).\n"
+	 "  -s <list>   Suites among spowm,fpowm,mr,safe (default all).\n"
+	 "  -f <format> Output format: text, json, or csv (default text).\n"
+	 "  -o <file>   Output file (default standard output).\n"
+	 "  -r <int>    Seed of the randomness (default 1).\n"
+	 "  -g <file>   Fail if a speedup is below its threshold in the\n"
+	 "              file or not measured, see perf_thresholds.txt.\n"
+	 "  -b <file>   Fail if an operation is slower than a fraction of\n"
+	 "              a baseline in CSV format from a previous run.\n"
+	 "  -T <frac>   Fraction of baseline required (default 0.8).\n"
+	 "  -p          Report hardware counters per operation: cycles,\n"
+	 "              instructions, L1 data cache read misses,\n"
+	 "              last-level cache misses, and branch misses.\n"
+	 "  -k          Print the kernels selected for the processor and\n"
+	 "              exit. The environment variable GMPMEE_KERNELS\n"
+	 "              overrides the Montgomery kernels, e.g., generic.\n\n"
+	 "Cycles are read from the time-stamp counter if available.\n"
+	 "Hardware counters are read using perf_event_open on Linux,\n"
+	 "and counters that are unavailable are reported as missing.\n",
+	 command_name);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int c;
+  int res = 0;
+  int failed = 0;
+  int available;
+  size_t i;
+  FILE *out = stdout;
+  const char *output = NULL;
+  bench_options opts;
+  bench_ctx ctx;
+
+  opts.modulus_len = parse_list(opts.modulus_bitlens, "1024,2048,3072", 0);
+  opts.exponent_len = parse_list(opts.exponent_bitlens, "256,0", 1);
+  opts.block_len = parse_list(opts.block_widths, "2,4,6,8,10", 0);
+  opts.safe_len = parse_list(opts.safe_bitlens, "256,512", 0);
+  opts.bases = 100;
+  opts.ms = 500;
+  opts.format = BENCH_TEXT;
+  opts.suites = "spowm,fpowm,mr,safe";
+  opts.seed = 1;
+  opts.thresholds = NULL;
+  opts.baseline = NULL;
+  opts.tolerance = 0.8;
+  opts.perf = 0;
+  for (c = 0; c < BENCH_PERF_EVENTS; c++)
+    {
+      opts.perf_fds[c] = -1;
+    }
+  opts.results = 0;
+
+  while ((c = getopt(argc, argv, "m:e:w:S:n:t:s:f:o:r:g:b:T:pkh")) != -1)
+    {
+      switch (c)
+	{
+	case 'm':
+	  res = (opts.modulus_len = parse_list(opts.modulus_bitlens,
+					       optarg, 0)) == 0;
+	  for (i = 0; i < opts.modulus_len; i++)
+	    {
+	      res = res || opts.modulus_bitlens[i] < 16;
+	    }
+	  break;
+	case 'e':
+	  res = (opts.exponent_len = parse_list(opts.exponent_bitlens,
+						optarg, 1)) == 0;
+	  break;
+	case 'w':
+	  res = (opts.block_len = parse_list(opts.block_widths,
+					     optarg, 0)) == 0;
+	  for (i = 0; i < opts.block_len; i++)
+	    {
+	      res = res || opts.block_widths[i] > 16;
+	    }
+	  break;
+	case 'S':
+	  res = (opts.safe_len = parse_list(opts.safe_bitlens,
+					    optarg, 0)) == 0;
+	  for (i = 0; i < opts.safe_len; i++)
+	    {
+	      res = res || opts.safe_bitlens[i] < 16;
+	    }
+	  break;
+	case 'n':
+	  res = sscanf(optarg, "%zu", &opts.bases) != 1 || opts.bases == 0;
+	  break;
+	case 't':
+	  res = sscanf(optarg, "%ld", &opts.ms) != 1 || opts.ms < 0;
+	  break;
+	case 's':
+	  opts.suites = optarg;
+	  break;
+	case 'f':
+	  if (strcmp(optarg, "text") == 0)
+	    {
+	      opts.format = BENCH_TEXT;
+	    }
+	  else if (strcmp(optarg, "json") == 0)
+	    {
+	      opts.format = BENCH_JSON;
+	    }
+	  else if (strcmp(optarg, "csv") == 0)
+	    {
+	      opts.format = BENCH_CSV;
+	    }
+	  else
+	    {
+	      res = 1;
+	    }
+	  break;
+	case 'o':
+	  output = optarg;
+	  break;
+	case 'r':
+	  res = sscanf(optarg, "%lu", &opts.seed) != 1;
+	  break;
+	case 'g':
+	  opts.thresholds = optarg;
+	  break;
+	case 'b':
+	  opts.baseline = optarg;
+	  break;
+	case 'T':
+	  res = sscanf(optarg, "%lf", &opts.tolerance) != 1
+	    || opts.tolerance <= 0;
+	  break;
+	case 'p':
+	  opts.perf = 1;
+	  break;
+	case 'k':
+	  gmpmee_kernels_fprint(stdout);
+	  exit(0);
+	case 'h':
+	  usage(argv[0]);
+	  exit(0);
+	default:
+	  res = 1;
+	}
+      if (res)
+	{
+	  usage(argv[0]);
+	  exit(1);
+	}
+    }
+
+  /* The benchmark still runs without hardware counters. */
+  if (opts.perf)
+    {
+      available = perf_open(&opts);
+      if (available < BENCH_PERF_EVENTS)
+	{
+	  fprintf(stderr, "Only %d of %d hardware counters are "
+		  "available!\n", available, BENCH_PERF_EVENTS);
+	}
+    }
+
+  if (output != NULL && (out = fopen(output, "w")) == NULL)
+    {
+      fprintf(stderr, "Unable to open %s!\n", output);
+      exit(1);
+    }
+
+  gmp_randinit_default(ctx.rstate);
+  gmp_randseed_ui(ctx.rstate, opts.seed);
+  mpz_init(ctx.modulus);
+  mpz_init(ctx.rop);
+  mpz_init(ctx.tmp);
+  ctx.res = 0;
+  ctx.len = opts.bases;
+  ctx.bases = gmpmee_array_alloc_init(ctx.len);
+  ctx.exponents = gmpmee_array_alloc_init(ctx.len);
+
+  if (opts.format == BENCH_JSON)
+    {
+      fprintf(out, "{\n  \"lanes\": %u,\n  \"kernels\": \"%s\",\n"
+	      "  \"cycles\": \"%s\",\n  \"results\": [\n",
+	      gmpmee_lanes(), gmpmee_kernels->name,
+	      cycles() < 0 ? "none" : "tsc");
+    }
+  else if (opts.format == BENCH_CSV)
+    {
+      fprintf(out, "suite,op,modulus_bits,exponent_bits,param,ops,"
+	      "seconds,ops_per_sec,cycles_per_op");
+      for (c = 0; opts.perf && c < BENCH_PERF_EVENTS; c++)
+	{
+	  fprintf(out, ",%s_per_op", perf_names[c]);
+	}
+      fprintf(out, "\n");
+    }
+  else
+    {
+      fprintf(out, "%-6s %-32s %6s %6s %6s %14s %14s",
+	      "suite", "op", "mbits", "ebits", "param", "ops/sec",
+	      "cycles/op");
+      for (c = 0; opts.perf && c < BENCH_PERF_EVENTS; c++)
+	{
+	  fprintf(out, " %14s", perf_names[c]);
+	}
+      fprintf(out, "\n");
+    }
+
+  if (selected(&opts, "spowm"))
+    {
+      suite_spowm(out, &opts, &ctx);
+    }
+  if (selected(&opts, "fpowm"))
+    {
+      suite_fpowm(out, &opts, &ctx);
+    }
+  if (selected(&opts, "mr"))
+    {
+      suite_mr(out, &opts, &ctx);
+    }
+  if (selected(&opts, "safe"))
+    {
+      suite_safe(out, &opts, &ctx);
+    }
+
+  if (opts.format == BENCH_JSON)
+    {
+      fprintf(out, "\n  ]\n}\n");
+    }
+
+  /* Performance is checked like correctness if requested. */
+  if (opts.thresholds != NULL)
+    {
+      failed = check_thresholds(&opts);
+    }
+  if (opts.baseline != NULL && failed >= 0)
+    {
+      c = check_baseline(&opts);
+      failed = c < 0 ? c : failed + c;
+    }
+
+  perf_close(&opts);
+  gmpmee_array_clear_dealloc(ctx.exponents, ctx.len);
+  gmpmee_array_clear_dealloc(ctx.bases, ctx.len);
+  mpz_clear(ctx.tmp);
+  mpz_clear(ctx.rop);
+  mpz_clear(ctx.modulus);
+  gmp_randclear(ctx.rstate);
+
+  if (out != stdout)
+    {
+      fclose(out);
+    }
+
+  if (failed != 0)
+    {
+      fprintf(stderr, "Performance check failed!\n");
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a trace of calls recorded with gmpmee_trace_fprint. Each
+ * call is executed again with random integers of the recorded shape,
+ * and the recorded and replayed running times are reported for each
+ * distinct shape. This allows evaluating tuning and changes of the
+ * library on a recorded workload.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Output formats.
+ */
+#define REPLAY_TEXT 0
+#define REPLAY_CSV 1
+
+/*
+ * Accumulated running times of the calls of a given shape.
+ */
+typedef struct
+{
+  gmpmee_trace_record_struct shape; /* Shape, the time is ignored. */
+  size_t calls;                     /* Number of calls. */
+  double recorded;                  /* Total recorded seconds. */
+  double replayed;                  /* Total replayed seconds. */
+} replay_shape;
+
+/*
+ * Inputs of replayed calls, which are reallocated when a call needs
+ * more bases than allocated.
+ */
+typedef struct
+{
+  gmp_randstate_t rstate;
+  mpz_t modulus;
+  mpz_t rop;
+  size_t len;
+  mpz_t *bases;
+  mpz_t *exponents;
+  mpz_t *rops;
+} replay_ctx;
+
+/*
+ * Generates a random modulus and random bases and exponents of the
+ * shape of the record.
+ */
+static void
+generate(replay_ctx *ctx, gmpmee_trace_record record)
+{
+  size_t i;
+  size_t mbits = record->modulus_bitlen < 2 ? 2 : record->modulus_bitlen;
+
+  if (record->len > ctx->len)
+    {
+      gmpmee_array_clear_dealloc(ctx->rops, ctx->len);
+      gmpmee_array_clear_dealloc(ctx->exponents, ctx->len);
+      gmpmee_array_clear_dealloc(ctx->bases, ctx->len);
+      ctx->len = record->len;
+      ctx->bases = gmpmee_array_alloc_init(ctx->len);
+      ctx->exponents = gmpmee_array_alloc_init(ctx->len);
+      ctx->rops = gmpmee_array_alloc_init(ctx->len);
+    }
+
+  mpz_urandomb(ctx->modulus, ctx->rstate, mbits);
+  mpz_setbit(ctx->modulus, mbits - 1);
+  mpz_setbit(ctx->modulus, 0);
+
+  for (i = 0; i < record->len; i++)
+    {
+      mpz_urandomm(ctx->bases[i], ctx->rstate, ctx->modulus);
+      mpz_set_ui(ctx->exponents[i], 0);
+      if (record->exponent_bitlen > 0)
+	{
+	  mpz_urandomb(ctx->exponents[i], ctx->rstate,
+		       record->exponent_bitlen);
+	  mpz_setbit(ctx->exponents[i], record->exponent_bitlen - 1);
+	}
+    }
+}
+
+/*
+ * Replays a call and returns its running time in seconds. Tables
+ * needed by a call are built before the clock is started. The block
+ * width is replaced by the given width unless it is zero.
+ */
+static double
+replay(replay_ctx *ctx, gmpmee_trace_record record, size_t width)
+{
+  double start;
+  double stop;
+  size_t len = record->len;
+  size_t block_width = width > 0 ? width : record->block_width;
+  size_t batch_len = record->batch_len;
+  gmpmee_spowm_tab stab;
+  gmpmee_fpowm_tab ftab;
+
+  if (block_width == 0)
+    {
+      block_width = 1;
+    }
+  generate(ctx, record);
+
+  switch (record->op)
+    {
+    case GMPMEE_TRACE_SPOWM:
+      start = gmpmee_stats_seconds();
+      if (width > 0)
+	{
+	  gmpmee_spowm_block_batch(ctx->rop, ctx->bases, ctx->exponents, len,
+				   ctx->modulus, width, len);
+	}
+      else
+	{
+	  gmpmee_spowm(ctx->rop, ctx->bases, ctx->exponents, len,
+		       ctx->modulus);
+	}
+      stop = gmpmee_stats_seconds();
+      break;
+    case GMPMEE_TRACE_SPOWM_BLOCK_BATCH:
+      if (batch_len == 0 || batch_len > len)
+	{
+	  batch_len = len;
+	}
+      start = gmpmee_stats_seconds();
+      gmpmee_spowm_block_batch(ctx->rop, ctx->bases, ctx->exponents, len,
+			       ctx->modulus, block_width, batch_len);
+      stop = gmpmee_stats_seconds();
+      break;
+    case GMPMEE_TRACE_SPOWM_NAIVE:
+      start = gmpmee_stats_seconds();
+      gmpmee_spowm_naive(ctx->rop, ctx->bases, ctx->exponents, len,
+			 ctx->modulus);
+      stop = gmpmee_stats_seconds();
+      break;
+    case GMPMEE_TRACE_SPOWM_PRECOMP:
+      gmpmee_spowm_init(stab, len, ctx->modulus, block_width);
+      start = gmpmee_stats_seconds();
+      gmpmee_spowm_precomp(stab, ctx->bases);
+      stop = gmpmee_stats_seconds();
+      gmpmee_spowm_clear(stab);
+      break;
+    case GMPMEE_TRACE_SPOWM_TABLE:
+      gmpmee_spowm_init(stab, len, ctx->modulus, block_width);
+      gmpmee_spowm_precomp(stab, ctx->bases);
+      start = gmpmee_stats_seconds();
+      gmpmee_spowm_table(ctx->rop, stab, ctx->exponents);
+      stop = gmpmee_stats_seconds();
+      gmpmee_spowm_clear(stab);
+      break;
+    case GMPMEE_TRACE_FPOWM_PRECOMP:
+      gmpmee_fpowm_init(ftab, ctx->modulus, block_width, batch_len);
+      start = gmpmee_stats_seconds();
+      gmpmee_fpowm_precomp(ftab, ctx->bases[0]);
+      stop = gmpmee_stats_seconds();
+      gmpmee_fpowm_clear(ftab);
+      break;
+    case GMPMEE_TRACE_FPOWM_BATCH:
+      gmpmee_fpowm_init_precomp(ftab, ctx->bases[0], ctx->modulus,
+				block_width, batch_len);
+      start = gmpmee_stats_seconds();
+      gmpmee_fpowm_batch(ctx->rops, ftab, ctx->exponents, len);
+      stop = gmpmee_stats_seconds();
+      gmpmee_fpowm_clear(ftab);
+      break;
+    case GMPMEE_TRACE_ARRAY_POWM:
+      start = gmpmee_stats_seconds();
+      gmpmee_array_powm(ctx->rops, ctx->bases, ctx->exponents, len,
+			ctx->modulus);
+      stop = gmpmee_stats_seconds();
+      break;
+    default:
+      gmpmee_fpowm_init_precomp(ftab, ctx->bases[0], ctx->modulus,
+				block_width, batch_len);
+      start = gmpmee_stats_seconds();
+      gmpmee_fpowm(ctx->rop, ftab, ctx->exponents[0]);
+      stop = gmpmee_stats_seconds();
+      gmpmee_fpowm_clear(ftab);
+    }
+  return stop - start;
+}
+
+/*
+ * Returns the accumulated times of the shape of the record, which is
+ * added to the array of shapes if it is not already present.
+ */
+static replay_shape *
+lookup(replay_shape **shapes, size_t *shapes_len, size_t *shapes_cap,
+       gmpmee_trace_record record)
+{
+  size_t i;
+  gmpmee_trace_record_struct *s;
+
+  for (i = 0; i < *shapes_len; i++)
+    {
+      s = &(*shapes)[i].shape;
+      if (s->op == record->op && s->len == record->len
+	  && s->modulus_bitlen == record->modulus_bitlen
+	  && s->exponent_bitlen == record->exponent_bitlen
+	  && s->block_width == record->block_width
+	  && s->batch_len == record->batch_len)
+	{
+	  return &(*shapes)[i];
+	}
+    }
+
+  if (*shapes_len == *shapes_cap)
+    {
+      *shapes_cap = 2 * *shapes_cap + 16;
+      *shapes = (replay_shape *)realloc(*shapes,
+					*shapes_cap * sizeof(replay_shape));
+    }
+  (*shapes)[i].shape = *record;
+  (*shapes)[i].calls = 0;
+  (*shapes)[i].recorded = 0;
+  (*shapes)[i].replayed = 0;
+  (*shapes_len)++;
+  return &(*shapes)[i];
+}
+
+/*
+ * Writes a row of the output.
+ */
+static void
+write_row(FILE *out, int format, const char *op,
+	  gmpmee_trace_record_struct *s, size_t calls, double recorded,
+	  double replayed)
+{
+  double speedup = replayed > 0 ? recorded / replayed : 0;
+
+  if (format == REPLAY_CSV)
+    {
+      fprintf(out, "%s,%zu,%zu,%zu,%zu,%zu,%zu,%.9f,%.9f,%.3f\n",
+	      op, s->len, s->modulus_bitlen, s->exponent_bitlen,
+	      s->block_width, s->batch_len, calls, recorded, replayed,
+	      speedup);
+    }
+  else
+    {
+      fprintf(out, "%-18s %6zu %6zu %6zu %5zu %6zu %8zu %12.3f %12.3f %7.2f\n",
+	      op, s->len, s->modulus_bitlen, s->exponent_bitlen,
+	      s->block_width, s->batch_len, calls, 1000 * recorded / calls,
+	      1000 * replayed / calls, speedup);
+    }
+}
+
+static void
+usage(char *command_name)
+{
+  printf("Usage: %s [options] <trace>\n\n"
+	 "  -w <int>    Replace recorded block widths (default 0, which\n"
+	 "              keeps them).\n"
+	 "  -f <format> Output format: text or csv (default text).\n"
+	 "  -o <file>   Output file (default standard output).\n"
+	 "  -r <int>    Seed of the randomness (default 1).\n\n"
+	 "A trace is recorded by registering gmpmee_trace_fprint with\n"
+	 "gmpmee_trace_set. Times are per call in milliseconds, and the\n"
+	 "speedup is the recorded time divided by the replayed time.\n",
+	 command_name);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int c;
+  int res = 0;
+  int format = REPLAY_TEXT;
+  size_t i;
+  size_t width = 0;
+  size_t lines = 0;
+  unsigned long int seed = 1;
+  double seconds;
+  double recorded = 0;
+  double replayed = 0;
+  FILE *in;
+  FILE *out = stdout;
+  const char *output = NULL;
+  gmpmee_trace_record record;
+  gmpmee_trace_record_struct total;
+  replay_shape *shape;
+  replay_shape *shapes = NULL;
+  size_t shapes_len = 0;
+  size_t shapes_cap = 0;
+  replay_ctx ctx;
+
+  while ((c = getopt(argc, argv, "w:f:o:r:h")) != -1)
+    {
+      switch (c)
+	{
+	case 'w':
+	  res = sscanf(optarg, "%zu", &width) != 1 || width > 16;
+	  break;
+	case 'f':
+	  if (strcmp(optarg, "text") == 0)
+	    {
+	      format = REPLAY_TEXT;
+	    }
+	  else if (strcmp(optarg, "csv") == 0)
+	    {
+	      format = REPLAY_CSV;
+	    }
+	  else
+	    {
+	      res = 1;
+	    }
+	  break;
+	case 'o':
+	  output = optarg;
+	  break;
+	case 'r':
+	  res = sscanf(optarg, "%lu", &seed) != 1;
+	  break;
+	case 'h':
+	  usage(argv[0]);
+	  exit(0);
+	default:
+	  res = 1;
+	}
+      if (res)
+	{
+	  usage(argv[0]);
+	  exit(1);
+	}
+    }
+  if (optind != argc - 1)
+    {
+      usage(argv[0]);
+      exit(1);
+    }
+
+  if ((in = fopen(argv[optind], "r")) == NULL)
+    {
+      fprintf(stderr, "Unable to open %s!\n", argv[optind]);
+      exit(1);
+    }
+  if (output != NULL && (out = fopen(output, "w")) == NULL)
+    {
+      fprintf(stderr, "Unable to open %s!\n", output);
+      exit(1);
+    }
+
+  gmp_randinit_default(ctx.rstate);
+  gmp_randseed_ui(ctx.rstate, seed);
+  mpz_init(ctx.modulus);
+  mpz_init(ctx.rop);
+  ctx.len = 1;
+  ctx.bases = gmpmee_array_alloc_init(ctx.len);
+  ctx.exponents = gmpmee_array_alloc_init(ctx.len);
+  ctx.rops = gmpmee_array_alloc_init(ctx.len);
+
+  while (gmpmee_trace_fread(record, in))
+    {
+      lines++;
+      seconds = replay(&ctx, record, width);
+
+      shape = lookup(&shapes, &shapes_len, &shapes_cap, record);
+      shape->calls++;
+      shape->recorded += record->seconds;
+      shape->replayed += seconds;
+      recorded += record->seconds;
+      replayed += seconds;
+    }
+  if (!feof(in))
+    {
+      fprintf(stderr, "Malformed record after %zu records!\n", lines);
+      res = 1;
+    }
+  fclose(in);
+
+  if (format == REPLAY_CSV)
+    {
+      fprintf(out, "op,len,modulus_bits,exponent_bits,block_width,"
+	      "batch_len,calls,recorded,replayed,speedup\n");
+    }
+  else
+    {
+      fprintf(out, "%-18s %6s %6s %6s %5s %6s %8s %12s %12s %7s\n",
+	      "op", "len", "mbits", "ebits", "width", "batch", "calls",
+	      "recorded", "replayed", "speedup");
+    }
+  for (i = 0; i < shapes_len; i++)
+    {
+      write_row(out, format, gmpmee_trace_name(shapes[i].shape.op),
+		&shapes[i].shape, shapes[i].calls, shapes[i].recorded,
+		shapes[i].replayed);
+    }
+  if (lines > 0)
+    {
+      memset(&total, 0, sizeof(total));
+      write_row(out, format, "total", &total, lines, recorded, replayed);
+    }
+
+  free(shapes);
+  gmpmee_array_clear_dealloc(ctx.rops, ctx.len);
+  gmpmee_array_clear_dealloc(ctx.exponents, ctx.len);
+  gmpmee_array_clear_dealloc(ctx.bases, ctx.len);
+  mpz_clear(ctx.rop);
+  mpz_clear(ctx.modulus);
+  gmp_randclear(ctx.rstate);
+
+  if (out != stdout)
+    {
+      fclose(out);
+    }
+  return res;
+}
@@ -71,6 +71,1218 @@ test_miller_rabin_n(int call, gmp_randstate_t rstate, mpz_t n)
   mpz_clear(rop);
 }
 
+/*
+ * Compares the output of a sieve with trial division of each integer
+ * in the progression by the sieving primes.
+ */
+void
+test_sieve_progression(mpz_t start, mpz_t step, int safe)
+{
+  size_t i;
+  size_t j;
+  int survives;
+  unsigned long int bound;
+  gmpmee_sieve sieve;
+  gmpmee_sieve bsieve;
+  mpz_t x;
+  mpz_t y;
+
+  mpz_init_set(x, start);
+  mpz_init(y);
+
+  /* The default sieve is equivalent to a sieve with an explicit
+     bound. */
+  if (safe)
+    {
+      gmpmee_sieve_safe_init(sieve, start, step);
+    }
+  else
+    {
+      gmpmee_sieve_init(sieve, start, step);
+    }
+  bound = sieve->primes_len == 0 ? 0 : sieve->primes[sieve->primes_len - 1];
+  gmpmee_sieve_init_bound(bsieve, start, step, bound, safe);
+  for (i = 0; i < 2 * sieve->len; i++)
+    {
+      gmpmee_sieve_next(x, sieve);
+      gmpmee_sieve_next(y, bsieve);
+      assert(mpz_cmp(x, y) == 0);
+    }
+  gmpmee_sieve_clear(bsieve);
+  gmpmee_sieve_clear(sieve);
+
+  /* Use a moderate bound to keep trial division reasonably fast. */
+  mpz_set(x, start);
+  gmpmee_sieve_init_bound(sieve, start, step, 4096, safe);
+
+  for (i = 0; i < 3 * sieve->len; i++)
+    {
+      survives = 1;
+      for (j = 0; survives && j < sieve->primes_len; j++)
+        {
+          assert(mpz_cmp_ui(x, sieve->primes[j]) > 0);
+          survives = !mpz_divisible_ui_p(x, sieve->primes[j]);
+
+          if (safe)
+            {
+              assert(mpz_cmp_ui(x, 2 * sieve->primes[j] + 1) > 0);
+              mpz_sub_ui(y, x, 1);
+              survives = survives && !mpz_divisible_ui_p(y, sieve->primes[j]);
+            }
+        }
+
+      if (survives)
+        {
+          gmpmee_sieve_next(y, sieve);
+          assert(mpz_cmp(x, y) == 0);
+        }
+      mpz_add(x, x, step);
+    }
+
+  gmpmee_sieve_clear(sieve);
+  mpz_clear(y);
+  mpz_clear(x);
+}
+
+void
+test_sieve()
+{
+  int i;
+  int bitlens[] = {2, 4, 12, 64, 300, 1100};
+  gmp_randstate_t rstate;
+  mpz_t start;
+  mpz_t step;
+
+  gmp_randinit_default(rstate);
+  mpz_init(start);
+  mpz_init(step);
+
+  for (i = 0; i < (int)(sizeof(bitlens) / sizeof(int)); i++)
+    {
+      mpz_urandomb(start, rstate, bitlens[i]);
+      mpz_setbit(start, bitlens[i]);
+
+      mpz_set_ui(step, 2);
+      test_sieve_progression(start, step, 0);
+
+      mpz_set_ui(step, 6);
+      test_sieve_progression(start, step, 0);
+
+      mpz_urandomb(step, rstate, 100);
+      mpz_setbit(step, 0);
+      test_sieve_progression(start, step, 0);
+
+      mpz_set_ui(step, 4);
+      test_sieve_progression(start, step, 1);
+
+      mpz_urandomb(step, rstate, 100);
+      mpz_setbit(step, 2);
+      test_sieve_progression(start, step, 1);
+    }
+
+  mpz_clear(step);
+  mpz_clear(start);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies that trial division is exact for small integers and that
+ * it finds small factors of large integers.
+ */
+void
+test_trial()
+{
+  int i;
+  unsigned long int p;
+  unsigned long int bitlens[] = {64, 100, 1000, 3000, 9000, 13000};
+  size_t groups;
+  const gmpmee_trial_table_struct *table = gmpmee_trial_table();
+  gmp_randstate_t rstate;
+  mpz_t n;
+  mpz_t m;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(m);
+
+  /* Every odd composite below the bound has a factor smaller than
+     its square root. */
+  for (mpz_set_ui(n, 5); mpz_cmp_ui(n, 20000) < 0; mpz_add_ui(n, n, 2))
+    {
+      assert(gmpmee_millerrabin_trial(n) == (mpz_probab_prime_p(n, 20) > 0));
+      if (mpz_cmp_ui(n, 7) >= 0 && mpz_tstbit(n, 1))
+	{
+	  mpz_tdiv_q_2exp(m, n, 1);
+	  assert(gmpmee_millerrabin_safe_trial(n)
+		 == (mpz_probab_prime_p(n, 20) > 0
+		     && mpz_probab_prime_p(m, 20) > 0));
+	}
+    }
+
+  /* Groups are used up to a bound that grows with the bit length. */
+  for (i = 0; i < (int)(sizeof(bitlens) / sizeof(unsigned long int)); i++)
+    {
+      groups = gmpmee_trial_groups(bitlens[i], 0);
+      assert(groups > 0 && groups <= table->len);
+      assert(gmpmee_trial_groups(bitlens[i], 1) >= groups);
+
+      /* The largest prime used. */
+      p = table->primes[table->starts[groups] - 1];
+
+      mpz_urandomb(n, rstate, bitlens[i]);
+      mpz_setbit(n, bitlens[i]);
+      mpz_mul_ui(n, n, p);
+      if (mpz_even_p(n))
+	{
+	  mpz_add_ui(n, n, p);
+	}
+      assert(gmpmee_millerrabin_trial(n) == 0);
+
+      /* A product of primes larger than every prime of the table. */
+      mpz_set_ui(n, 1);
+      while (mpz_sizeinbase(n, 2) < bitlens[i])
+	{
+	  mpz_urandomb(m, rstate, 64);
+	  mpz_setbit(m, 63);
+	  mpz_nextprime(m, m);
+	  mpz_mul(n, n, m);
+	}
+      assert(gmpmee_millerrabin_trial(n) == 1);
+      assert(gmpmee_trial_gcd(n, table->len) == 1);
+      mpz_mul_ui(m, n, table->primes[table->primes_len - 1]);
+      assert(gmpmee_trial_gcd(m, table->len) == 0);
+      mpz_mul_ui(m, n, 3);
+      assert(gmpmee_trial_gcd(m, table->len) == 0);
+
+      /* An integer n such that (n-1)/2 is divisible by the prime. */
+      mpz_mul_ui(n, n, p);
+      mpz_mul_2exp(n, n, 1);
+      mpz_add_ui(n, n, 1);
+      assert(gmpmee_millerrabin_safe_trial(n) == 0);
+    }
+
+  mpz_clear(m);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+void
+test_mont()
+{
+  int i;
+  int j;
+  int bitlens[] = {2, 63, 64, 65, 300, 1100, 130};
+  mp_limb_t *ap;
+  mp_limb_t *bp;
+  gmp_randstate_t rstate;
+  gmpmee_mont mont;
+  mpz_t modulus;
+  mpz_t a;
+  mpz_t b;
+  mpz_t c;
+  mpz_t d;
+
+  gmp_randinit_default(rstate);
+  gmpmee_mont_init(mont);
+  mpz_init(modulus);
+  mpz_init(a);
+  mpz_init(b);
+  mpz_init(c);
+  mpz_init(d);
+
+  /* Even moduli and moduli smaller than three are undefined. */
+  mpz_set_ui(modulus, 10);
+  gmpmee_mont_set(mont, modulus);
+  assert(mont->size == 0);
+  mpz_set_ui(modulus, 1);
+  gmpmee_mont_set(mont, modulus);
+  assert(mont->size == 0);
+
+  /* The last modulus is shorter than its predecessor, so the
+     allocated space is reused. */
+  for (i = 0; i < (int)(sizeof(bitlens) / sizeof(int)); i++)
+    {
+      mpz_urandomb(modulus, rstate, bitlens[i]);
+      mpz_setbit(modulus, bitlens[i]);
+      mpz_setbit(modulus, 0);
+      gmpmee_mont_set(mont, modulus);
+      assert(mont->size == (mp_size_t)mpz_size(modulus));
+
+      ap = (mp_limb_t *)malloc(mont->size * sizeof(mp_limb_t));
+      bp = (mp_limb_t *)malloc(mont->size * sizeof(mp_limb_t));
+
+      /* One and minus one. */
+      gmpmee_mont_from(c, mont->one, mont);
+      assert(mpz_cmp_ui(c, 1) == 0);
+      gmpmee_mont_from(c, mont->minus_one, mont);
+      mpz_add_ui(c, c, 1);
+      assert(mpz_cmp(c, modulus) == 0);
+
+      for (j = 0; j < 20; j++)
+	{
+	  mpz_urandomm(a, rstate, modulus);
+	  mpz_urandomm(b, rstate, modulus);
+
+	  gmpmee_mont_to(ap, a, mont);
+	  gmpmee_mont_to(bp, b, mont);
+	  gmpmee_mont_from(c, ap, mont);
+	  assert(mpz_cmp(c, a) == 0);
+
+	  gmpmee_mont_mul(ap, ap, bp, mont);
+	  gmpmee_mont_from(c, ap, mont);
+	  mpz_mul(d, a, b);
+	  mpz_mod(d, d, modulus);
+	  assert(mpz_cmp(c, d) == 0);
+
+	  gmpmee_mont_sqr(bp, bp, mont);
+	  gmpmee_mont_from(c, bp, mont);
+	  mpz_mul(d, b, b);
+	  mpz_mod(d, d, modulus);
+	  assert(mpz_cmp(c, d) == 0);
+	}
+
+      free(bp);
+      free(ap);
+    }
+
+  mpz_clear(d);
+  mpz_clear(c);
+  mpz_clear(b);
+  mpz_clear(a);
+  mpz_clear(modulus);
+  gmpmee_mont_clear(mont);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies the Montgomery arithmetic with each kernel supported by
+ * the processor. Moduli with all bits set and operands close to the
+ * modulus maximize the carries in the reduction.
+ */
+void
+test_kernels()
+{
+  size_t i;
+  mp_size_t n;
+  const char *names[] = {"generic", "bmi2-adx"};
+  const gmpmee_kernels_struct *kernels = gmpmee_kernels;
+  mp_limb_t *ap;
+  mp_limb_t *tp;
+  gmpmee_mont mont;
+  mpz_t modulus;
+  mpz_t a;
+  mpz_t c;
+  mpz_t d;
+
+  assert(gmpmee_kernels_lookup(NULL) == kernels
+	 || getenv("GMPMEE_KERNELS") != NULL);
+  assert(gmpmee_kernels_lookup("unknown") == NULL);
+  assert(!gmpmee_kernels_select("unknown"));
+  assert(gmpmee_kernels == kernels);
+
+  gmpmee_mont_init(mont);
+  mpz_init(modulus);
+  mpz_init(a);
+  mpz_init(c);
+  mpz_init(d);
+
+  for (i = 0; i < sizeof(names) / sizeof(char *); i++)
+    {
+      if (!gmpmee_kernels_select(names[i]))
+	{
+	  continue;
+	}
+      assert(strcmp(gmpmee_kernels->name, names[i]) == 0);
+
+      test_mont();
+
+      for (n = 1; n <= 13; n++)
+	{
+	  mpz_set_ui(modulus, 0);
+	  mpz_setbit(modulus, n * GMP_NUMB_BITS);
+	  mpz_sub_ui(modulus, modulus, 1);
+	  gmpmee_mont_set(mont, modulus);
+
+	  ap = (mp_limb_t *)malloc(n * sizeof(mp_limb_t));
+	  tp = (mp_limb_t *)malloc(2 * n * sizeof(mp_limb_t));
+
+	  /* (-1)^2 = 1 */
+	  gmpmee_mont_sqr(ap, mont->minus_one, mont);
+	  assert(mpn_cmp(ap, mont->one, n) == 0);
+	  gmpmee_mont_mul(ap, mont->minus_one, mont->minus_one, mont);
+	  assert(mpn_cmp(ap, mont->one, n) == 0);
+
+	  /* Reduce the largest integer of 2n limbs smaller than mR. */
+	  mpz_mul_2exp(a, modulus, n * GMP_NUMB_BITS);
+	  mpz_sub_ui(a, a, 1);
+	  gmpmee_mont_limbs(tp, a, 2 * n);
+	  gmpmee_mont_redc(ap, tp, mont);
+	  gmpmee_mont_from(c, ap, mont);
+	  mpz_set_ui(d, 0);
+	  mpz_setbit(d, n * GMP_NUMB_BITS);
+	  mpz_mul(d, d, d);
+	  mpz_invert(d, d, modulus);
+	  mpz_mul(d, d, a);
+	  mpz_mod(d, d, modulus);
+	  assert(mpz_cmp(c, d) == 0);
+
+	  free(tp);
+	  free(ap);
+	}
+    }
+  gmpmee_kernels = kernels;
+
+  mpz_clear(d);
+  mpz_clear(c);
+  mpz_clear(a);
+  mpz_clear(modulus);
+  gmpmee_mont_clear(mont);
+}
+
+void
+test_lanes_bitlen(gmp_randstate_t rstate, unsigned int lanes, int bitlen)
+{
+  size_t i;
+  size_t len = 2 * GMPMEE_LANES_IFMA + 3;
+  int *results;
+  gmpmee_millerrabin_state *states;
+  gmpmee_millerrabin_state_ptr *ptrs;
+  mpz_t *rops;
+  mpz_t *bases;
+  mpz_t *exps;
+  mpz_t *moduli;
+
+  results = (int *)malloc(len * sizeof(int));
+  states = (gmpmee_millerrabin_state *)
+    malloc(len * sizeof(gmpmee_millerrabin_state));
+  ptrs = (gmpmee_millerrabin_state_ptr *)
+    malloc(len * sizeof(gmpmee_millerrabin_state_ptr));
+  rops = gmpmee_array_alloc_init(len);
+  bases = gmpmee_array_alloc_init(len);
+  exps = gmpmee_array_alloc_init(len);
+  moduli = gmpmee_array_alloc_init(len);
+
+  /* Moduli of different lengths, negative bases, and a zero
+     exponent. */
+  for (i = 0; i < len; i++)
+    {
+      mpz_urandomb(moduli[i], rstate, bitlen - i % 3);
+      mpz_setbit(moduli[i], 0);
+      mpz_urandomb(bases[i], rstate, bitlen + 10);
+      if (i % 2 == 1)
+        {
+          mpz_neg(bases[i], bases[i]);
+        }
+      mpz_urandomb(exps[i], rstate, bitlen - i % 5);
+    }
+  mpz_set_ui(exps[0], 0);
+
+  gmpmee_lanes_powm(rops, bases, exps, moduli, len, lanes);
+  for (i = 0; i < len; i++)
+    {
+      mpz_powm(exps[i], bases[i], exps[i], moduli[i]);
+      assert(mpz_cmp(rops[i], exps[i]) == 0);
+    }
+
+  /* Miller-Rabin for a prime unless this is too slow, composites, an
+     even integer, and a state that occurs twice. */
+  for (i = 0; i < len; i++)
+    {
+      if (i == 0 && bitlen <= 1100)
+        {
+          mpz_nextprime(moduli[i], moduli[i]);
+        }
+      if (i == 1)
+        {
+          mpz_add_ui(moduli[i], moduli[i], 1);
+        }
+      gmpmee_millerrabin_init(states[i], moduli[i]);
+      ptrs[i] = states[i];
+
+      mpz_sub_ui(bases[i], moduli[i], 3);
+      mpz_urandomm(bases[i], rstate, bases[i]);
+      mpz_add_ui(bases[i], bases[i], 2);
+    }
+  ptrs[len - 1] = states[0];
+  mpz_set(bases[len - 1], bases[0]);
+
+  gmpmee_millerrabin_once_lanes(results, ptrs, bases, len, lanes);
+  assert(bitlen > 1100 || (results[0] && results[len - 1]));
+  for (i = 0; i < len; i++)
+    {
+      assert(results[i] == gmpmee_millerrabin_once(ptrs[i], bases[i]));
+    }
+
+  for (i = 0; i < len; i++)
+    {
+      gmpmee_millerrabin_clear(states[i]);
+    }
+  gmpmee_array_clear_dealloc(moduli, len);
+  gmpmee_array_clear_dealloc(exps, len);
+  gmpmee_array_clear_dealloc(bases, len);
+  gmpmee_array_clear_dealloc(rops, len);
+  free(ptrs);
+  free(states);
+  free(results);
+}
+
+/*
+ * Verifies the Montgomery context of the multi-lane kernel with the
+ * given number of lanes against GMP.
+ */
+void
+test_lanes_mont(gmp_randstate_t rstate, unsigned int lanes, int bitlen)
+{
+  unsigned int l;
+  mpz_t moduli[GMPMEE_LANES_IFMA];
+  mpz_t a[GMPMEE_LANES_IFMA];
+  mpz_t b[GMPMEE_LANES_IFMA];
+  mpz_t c[GMPMEE_LANES_IFMA];
+  mpz_t d;
+  gmpmee_lanes_mont mont;
+  uint64_t *ap;
+  uint64_t *bp;
+
+  mpz_init(d);
+  for (l = 0; l < lanes; l++)
+    {
+      mpz_init(moduli[l]);
+      mpz_init(a[l]);
+      mpz_init(b[l]);
+      mpz_init(c[l]);
+      mpz_urandomb(moduli[l], rstate, bitlen - l % 2);
+      mpz_setbit(moduli[l], 0);
+      mpz_setbit(moduli[l], 1);
+      mpz_urandomb(a[l], rstate, bitlen + 5);
+      mpz_urandomm(b[l], rstate, moduli[l]);
+    }
+  mpz_neg(a[0], a[0]);
+  mpz_sub_ui(b[1], moduli[1], 1);
+
+  /* One modulus fewer than lanes, so the last lane uses the first. */
+  assert(gmpmee_lanes_mont_init(mont, moduli, lanes - 1, lanes));
+  mpz_set(moduli[lanes - 1], moduli[0]);
+  ap = gmpmee_lanes_alloc(mont->size);
+  bp = gmpmee_lanes_alloc(mont->size);
+  assert(((size_t)ap) % GMPMEE_LANES_ALIGN == 0);
+
+  /* Space that can not be allocated is reported. */
+  assert(gmpmee_lanes_alloc(SIZE_MAX) == NULL);
+
+  gmpmee_lanes_mont_to(mont, ap, a, lanes);
+  gmpmee_lanes_mont_to(mont, bp, b, lanes);
+
+  gmpmee_lanes_mont_mul(mont, bp, ap, bp);
+  gmpmee_lanes_mont_from(mont, c, bp, lanes);
+  for (l = 0; l < lanes; l++)
+    {
+      mpz_mul(d, a[l], b[l]);
+      mpz_mod(d, d, moduli[l]);
+      assert(mpz_cmp(c[l], d) == 0);
+    }
+
+  gmpmee_lanes_mont_sqr(mont, ap, ap);
+  gmpmee_lanes_mont_from(mont, c, ap, lanes);
+  for (l = 0; l < lanes; l++)
+    {
+      mpz_mul(d, a[l], a[l]);
+      mpz_mod(d, d, moduli[l]);
+      assert(mpz_cmp(c[l], d) == 0);
+    }
+
+  gmpmee_lanes_free(bp);
+  gmpmee_lanes_free(ap);
+  gmpmee_lanes_mont_clear(mont);
+  for (l = 0; l < lanes; l++)
+    {
+      mpz_clear(c[l]);
+      mpz_clear(b[l]);
+      mpz_clear(a[l]);
+      mpz_clear(moduli[l]);
+    }
+  mpz_clear(d);
+}
+
+/*
+ * Verifies the routines that batch operations with a common modulus
+ * against the scalar routines. The results are identical whether
+ * the multi-lane kernels are used or not.
+ */
+void
+test_lanes_batch(gmp_randstate_t rstate, int bitlen, int odd)
+{
+  size_t i, j, k;
+  size_t mask;
+  size_t len = 2 * GMPMEE_LANES_IFMA + 3;
+  size_t block_width = 4;
+  mpz_t *rops;
+  mpz_t *bases;
+  mpz_t *exps;
+  mpz_t modulus;
+  mpz_t d;
+  mpz_t e;
+  gmpmee_spowm_tab stab;
+  gmpmee_fpowm_tab ftab;
+
+  rops = gmpmee_array_alloc_init(len);
+  bases = gmpmee_array_alloc_init(len);
+  exps = gmpmee_array_alloc_init(len);
+  mpz_init(modulus);
+  mpz_init(d);
+  mpz_init(e);
+
+  mpz_urandomb(modulus, rstate, bitlen);
+  mpz_setbit(modulus, bitlen - 1);
+  if (odd)
+    {
+      mpz_setbit(modulus, 0);
+    }
+  else
+    {
+      mpz_clrbit(modulus, 0);
+    }
+  for (i = 0; i < len; i++)
+    {
+      mpz_urandomb(bases[i], rstate, bitlen + 3);
+      if (i % 3 == 1)
+        {
+          mpz_neg(bases[i], bases[i]);
+        }
+      mpz_urandomb(exps[i], rstate, bitlen - i % 7);
+    }
+  mpz_set_ui(exps[1], 0);
+  mpz_set(bases[2], modulus);
+
+  /* Element-wise exponentiation, including a single one. */
+  for (k = 1; k <= len; k += len - 1)
+    {
+      gmpmee_array_powm(rops, bases, exps, k, modulus);
+      for (i = 0; i < k; i++)
+        {
+          mpz_powm(d, bases[i], exps[i], modulus);
+          assert(mpz_cmp(rops[i], d) == 0);
+        }
+    }
+
+  /* Subset tables, the last of smaller width. For odd moduli only
+     the Montgomery table is filled. */
+  gmpmee_spowm_init(stab, len, modulus, block_width);
+  gmpmee_spowm_precomp(stab, bases);
+  assert((stab->mtabs != NULL) == (odd != 0) && (stab->tabs == NULL) == odd);
+  for (i = 0; i < stab->tabs_len; i++)
+    {
+      for (mask = 0; mask < ((size_t)1 << block_width); mask++)
+        {
+          if (i * block_width + block_width > len
+              && mask >= ((size_t)1 << (len - i * block_width)))
+            {
+              break;
+            }
+          mpz_set_ui(d, 1);
+          for (j = 0; j < block_width; j++)
+            {
+              if (mask & ((size_t)1 << j))
+                {
+                  mpz_mul(d, d, bases[i * block_width + j]);
+                  mpz_mod(d, d, modulus);
+                }
+            }
+          if (odd)
+            {
+              gmpmee_mont_from(e, stab->mtabs + ((i << block_width) + mask)
+                               * stab->mont->size, stab->mont);
+            }
+          else
+            {
+              mpz_set(e, stab->tabs[i][mask]);
+            }
+          assert(mpz_cmp(e, d) == 0);
+        }
+    }
+  gmpmee_spowm_clear(stab);
+
+  /* Fixed-base exponentiation of exponents of different lengths. */
+  gmpmee_fpowm_init_precomp(ftab, bases[0], modulus, block_width, bitlen);
+  gmpmee_fpowm_batch(rops, ftab, exps, len);
+  for (i = 0; i < len; i++)
+    {
+      gmpmee_fpowm(d, ftab, exps[i]);
+      assert(mpz_cmp(rops[i], d) == 0);
+    }
+  gmpmee_fpowm_clear(ftab);
+
+  mpz_clear(e);
+  mpz_clear(d);
+  mpz_clear(modulus);
+  gmpmee_array_clear_dealloc(exps, len);
+  gmpmee_array_clear_dealloc(bases, len);
+  gmpmee_array_clear_dealloc(rops, len);
+}
+
+void
+test_lanes()
+{
+  size_t i;
+  unsigned int j;
+  int bitlens[] = {64, 300, 520, 1024, 1100, 2048, 4000};
+  int batch_bitlens[] = {64, 1024, 2048, 3072, 4096};
+  unsigned int lanes[] = {0, GMPMEE_LANES_AVX2, GMPMEE_LANES_IFMA};
+  gmp_randstate_t rstate;
+
+  gmp_randinit_default(rstate);
+
+  /* Kernels that are not supported by the processor are skipped. */
+  for (j = 0; j < sizeof(lanes) / sizeof(unsigned int); j++)
+    {
+      if (lanes[j] > gmpmee_lanes())
+        {
+          continue;
+        }
+      for (i = 0; i < sizeof(bitlens) / sizeof(int); i++)
+        {
+          test_lanes_bitlen(rstate, lanes[j], bitlens[i]);
+          if (lanes[j] > 0)
+            {
+              test_lanes_mont(rstate, lanes[j], bitlens[i]);
+            }
+        }
+    }
+
+  for (i = 0; i < sizeof(batch_bitlens) / sizeof(int); i++)
+    {
+      test_lanes_batch(rstate, batch_bitlens[i], 1);
+      test_lanes_batch(rstate, batch_bitlens[i], 0);
+    }
+
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies the deterministic test of integers that fit in an unsigned
+ * long, and that single rounds agree with the general test.
+ */
+void
+test_miller_rabin_ui(long test_time)
+{
+  int t;
+  int res;
+  unsigned long int u;
+  unsigned long int b;
+  gmp_randstate_t rstate;
+  gmpmee_millerrabin_state state;
+  mpz_t n;
+  mpz_t base;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(base);
+
+  for (u = 0; u < 100000; u++)
+    {
+      mpz_set_ui(n, u);
+      assert(gmpmee_millerrabin_ui(u) == (mpz_probab_prime_p(n, 25) > 0));
+    }
+
+  /* Strong pseudoprimes to base 2, to the bases 2, 3, 5, and 7, and
+     to every prime base up to 23. */
+  assert(gmpmee_millerrabin_once_ui(2047, 2) == 1);
+  assert(gmpmee_millerrabin_ui(2047) == 0);
+  assert(gmpmee_millerrabin_ui(3215031751UL) == 0);
+  mpz_set_str(n, "3825123056546413051", 10);
+  if (mpz_fits_ulong_p(n))
+    {
+      assert(gmpmee_millerrabin_ui(mpz_get_ui(n)) == 0);
+    }
+
+  t = clock();
+  do
+    {
+      /* Random integers, primes, and products of two primes. */
+      mpz_urandomb(n, rstate, 1 + gmp_urandomm_ui(rstate,
+						  8 * sizeof(unsigned long int)));
+      u = mpz_get_ui(n);
+      assert(gmpmee_millerrabin_ui(u) == (mpz_probab_prime_p(n, 25) > 0));
+
+      mpz_nextprime(n, n);
+      if (mpz_fits_ulong_p(n))
+	{
+	  assert(gmpmee_millerrabin_ui(mpz_get_ui(n)) == 1);
+	}
+
+      mpz_urandomb(n, rstate, 4 * sizeof(unsigned long int));
+      mpz_nextprime(n, n);
+      mpz_mul(n, n, n);
+      if (mpz_fits_ulong_p(n))
+	{
+	  assert(gmpmee_millerrabin_ui(mpz_get_ui(n)) == 0);
+	}
+
+      /* A single round agrees with the general test. */
+      mpz_urandomb(n, rstate, 8 * sizeof(unsigned long int));
+      mpz_setbit(n, 0);
+      if (mpz_cmp_ui(n, 5) >= 0)
+	{
+	  u = mpz_get_ui(n);
+	  b = 2 + gmp_urandomm_ui(rstate, u - 3);
+	  mpz_set_ui(base, b);
+	  gmpmee_millerrabin_init(state, n);
+	  mpz_powm(state->y, base, state->q, state->n);
+	  res = gmpmee_millerrabin_once_finish(state);
+	  assert(gmpmee_millerrabin_once_ui(u, b) == res);
+	  assert(gmpmee_millerrabin_once(state, base) == res);
+	  gmpmee_millerrabin_clear(state);
+	}
+    }
+  while (!gmpmee_done(t, test_time));
+
+  mpz_clear(base);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies the strong Lucas test on known pseudoprimes and the
+ * Baillie-PSW tests against GMP's primality test.
+ */
+void
+test_miller_rabin_bpsw(long test_time)
+{
+  int t;
+  int i;
+  unsigned long int u;
+  unsigned long int lucas_psp[] = {5459, 5777, 10877, 16109, 18971};
+  unsigned long int mr_psp[] = {2047, 3277, 4033, 4681, 8321};
+  gmp_randstate_t rstate;
+  gmpmee_millerrabin_state state;
+  gmpmee_millerrabin_safe_state safe_state;
+  mpz_t n;
+  mpz_t m;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(m);
+
+  /* Strong Lucas pseudoprimes pass the Lucas test and strong
+     pseudoprimes to base two do not. */
+  for (i = 0; i < 5; i++)
+    {
+      mpz_set_ui(n, lucas_psp[i]);
+      gmpmee_millerrabin_init(state, n);
+      assert(gmpmee_millerrabin_lucas(state) == 1);
+      assert(gmpmee_millerrabin_bpsw_rs(rstate, state, 0) == 0);
+      gmpmee_millerrabin_clear(state);
+
+      mpz_set_ui(n, mr_psp[i]);
+      gmpmee_millerrabin_init(state, n);
+      assert(gmpmee_millerrabin_lucas(state) == 0);
+      assert(gmpmee_millerrabin_bpsw_rs(rstate, state, 0) == 0);
+      gmpmee_millerrabin_clear(state);
+    }
+
+  for (u = 5; u < 100000; u += 2)
+    {
+      mpz_set_ui(n, u);
+      gmpmee_millerrabin_init(state, n);
+      assert(gmpmee_millerrabin_bpsw_rs(rstate, state, 0)
+	     == (mpz_probab_prime_p(n, 25) > 0));
+      gmpmee_millerrabin_clear(state);
+    }
+
+  t = clock();
+  do
+    {
+      /* Primes pass and products of two primes fail. */
+      mpz_urandomb(n, rstate, 200 + gmp_urandomm_ui(rstate, 900));
+      mpz_nextprime(n, n);
+      gmpmee_millerrabin_init(state, n);
+      assert(gmpmee_millerrabin_bpsw_rs(rstate, state, 1) == 1);
+      gmpmee_millerrabin_clear(state);
+
+      mpz_urandomb(m, rstate, 100 + gmp_urandomm_ui(rstate, 450));
+      mpz_nextprime(m, m);
+      mpz_mul(n, n, m);
+      gmpmee_millerrabin_init(state, n);
+      assert(gmpmee_millerrabin_bpsw_rs(rstate, state, 0) == 0);
+      gmpmee_millerrabin_clear(state);
+
+      /* The safe variant agrees with the plain safe-prime test. */
+      mpz_urandomb(n, rstate, 64 + gmp_urandomm_ui(rstate, 200));
+      gmpmee_millerrabin_safe_next_rs(n, rstate, n, 20);
+      gmpmee_millerrabin_safe_init(safe_state, n);
+      assert(gmpmee_millerrabin_safe_bpsw_rs(rstate, safe_state, 1) == 1);
+      gmpmee_millerrabin_safe_clear(safe_state);
+
+      mpz_add_ui(n, n, 4 * (1 + gmp_urandomm_ui(rstate, 1000)));
+      gmpmee_millerrabin_safe_init(safe_state, n);
+      assert(gmpmee_millerrabin_safe_bpsw_rs(rstate, safe_state, 0)
+	     == gmpmee_millerrabin_safe_rs(rstate, n, 20));
+      gmpmee_millerrabin_safe_clear(safe_state);
+    }
+  while (!gmpmee_done(t, test_time));
+
+  mpz_clear(m);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies the repetition counts derived from error targets and the
+ * searches using them.
+ */
+void
+test_miller_rabin_error(long test_time)
+{
+  int t;
+  unsigned long int bitlen;
+  gmp_randstate_t rstate;
+  mpz_t n;
+  mpz_t p;
+  mpz_t r;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(p);
+  mpz_init(r);
+
+  assert(gmpmee_millerrabin_error_reps(1024, 100, 0) == 50);
+  assert(gmpmee_millerrabin_error_reps(1024, 0, 0) == 1);
+  assert(gmpmee_millerrabin_error_reps(1024, 80, 1) == 3);
+
+  /* More bits never need more rounds and a smaller error never needs
+     fewer rounds for random integers. */
+  for (bitlen = 2; bitlen < 8192; bitlen += 17)
+    {
+      t = gmpmee_millerrabin_error_reps(bitlen, 128, 1);
+      assert(t >= 1 && t <= 64);
+      assert(gmpmee_millerrabin_error_reps(bitlen + 17, 128, 1) <= t);
+      assert(gmpmee_millerrabin_error_reps(bitlen, 64, 1) <= t);
+    }
+
+  t = clock();
+  do
+    {
+      mpz_urandomb(n, rstate, 2 + gmp_urandomm_ui(rstate, 600));
+
+      gmpmee_millerrabin_next_error_rs(r, rstate, n, 80, 1);
+      mpz_nextprime(p, n);
+      assert(mpz_cmp(r, p) == 0);
+
+      gmpmee_millerrabin_safe_next_error_rs(r, rstate, n, 80, 1);
+      gmpmee_millerrabin_safe_next_rs(p, rstate, n, 20);
+      assert(mpz_cmp(r, p) == 0);
+    }
+  while (!gmpmee_done(t, test_time));
+
+  mpz_clear(r);
+  mpz_clear(p);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Counts the calls of the progress callback of a search and
+ * verifies that the counters are consistent.
+ */
+void
+test_safe_search_progress(gmpmee_millerrabin_safe_search_struct *search,
+			  void *arg)
+{
+  assert(search->tested <= search->sieved);
+  (*(int *)arg)++;
+}
+
+/*
+ * Verifies that a resumable safe-prime search that is interrupted,
+ * written to a stream, and read back finds the same safe prime as
+ * an uninterrupted search.
+ */
+void
+test_miller_rabin_safe_search(long test_time)
+{
+  int t;
+  int calls;
+  unsigned long int u;
+  unsigned long int tested;
+  gmp_randstate_t rstate;
+  gmpmee_millerrabin_safe_search search;
+  FILE *stream;
+  mpz_t start;
+  mpz_t end;
+  mpz_t expected;
+
+  gmp_randinit_default(rstate);
+  mpz_init(start);
+  mpz_init(end);
+  mpz_init(expected);
+
+  /* Small starting points and ranges. */
+  for (u = 0; u < 64; u++)
+    {
+      mpz_set_ui(start, u);
+      mpz_set_ui(end, u + 24);
+      gmpmee_millerrabin_safe_search_init(search, start, end, 20);
+      gmpmee_millerrabin_safe_search_run_rs(search, rstate, 0, 0, 1,
+					    NULL, NULL);
+      mpz_set_ui(expected, u == 0 ? 0 : u - 1);
+      mpz_probab_safe_prime_p_next(expected, expected, 20);
+      assert(search->found == (mpz_cmp(expected, end) < 0));
+      assert(search->exhausted == !search->found);
+      assert(!search->found || mpz_cmp(search->result, expected) == 0);
+      gmpmee_millerrabin_safe_search_clear(search);
+    }
+
+  t = clock();
+  do
+    {
+      mpz_urandomb(start, rstate, 64 + gmp_urandomm_ui(rstate, 200));
+      mpz_sub_ui(expected, start, 1);
+      gmpmee_millerrabin_safe_next_rs(expected, rstate, expected, 20);
+
+      /* Run a few candidates at a time and resume from a stream. */
+      mpz_set_ui(end, 0);
+      gmpmee_millerrabin_safe_search_init(search, start, end, 20);
+      calls = 0;
+      tested = 0;
+      while (!gmpmee_millerrabin_safe_search_run_rs(search, rstate,
+						    1 + gmp_urandomm_ui(rstate,
+									40),
+						    0, 2,
+						    test_safe_search_progress,
+						    &calls))
+	{
+	  assert(search->tested > tested);
+	  tested = search->tested;
+
+	  stream = tmpfile();
+	  assert(gmpmee_millerrabin_safe_search_fwrite(stream, search));
+	  gmpmee_millerrabin_safe_search_clear(search);
+	  rewind(stream);
+	  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 20));
+	  fclose(stream);
+	  assert(search->tested == tested);
+	}
+      assert(calls > 0);
+      assert(search->found && !search->exhausted);
+      assert(mpz_cmp(search->result, expected) == 0);
+      tested = search->tested;
+      gmpmee_millerrabin_safe_search_clear(search);
+
+      /* A range that ends at the safe prime is exhausted, and every
+	 candidate except the safe prime is tested. */
+      gmpmee_millerrabin_safe_search_init(search, start, expected, 20);
+      assert(gmpmee_millerrabin_safe_search_run_rs(search, rstate, 0, 0, 1,
+						   NULL, NULL) == 1);
+      assert(!search->found && search->exhausted);
+      assert(search->tested == tested - 1);
+      gmpmee_millerrabin_safe_search_clear(search);
+    }
+  while (!gmpmee_done(t, test_time));
+
+  /* Invalid input is rejected. */
+  stream = tmpfile();
+  fputs("gmpmee_safe_search 0\n", stream);
+  rewind(stream);
+  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 20) == 0);
+  fclose(stream);
+
+  /* Inconsistent states and other repetitions are rejected. */
+  stream = tmpfile();
+  fprintf(stream, "gmpmee_safe_search 1\n20 1 0\nb\n0\n0\n0 0 0 %zu\n",
+	  (size_t)GMPMEE_SAFE_SEARCH_MIN_CHUNK);
+  rewind(stream);
+  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 20) == 0);
+  fclose(stream);
+
+  stream = tmpfile();
+  fprintf(stream, "gmpmee_safe_search 1\n20 0 1\nb\n0\n0\n0 0 0 %zu\n",
+	  (size_t)GMPMEE_SAFE_SEARCH_MIN_CHUNK);
+  rewind(stream);
+  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 20) == 0);
+  fclose(stream);
+
+  mpz_set_ui(start, 1000);
+  mpz_set_ui(end, 0);
+  gmpmee_millerrabin_safe_search_init(search, start, end, 20);
+  stream = tmpfile();
+  assert(gmpmee_millerrabin_safe_search_fwrite(stream, search));
+  gmpmee_millerrabin_safe_search_clear(search);
+  rewind(stream);
+  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 10) == 0);
+  rewind(stream);
+  assert(gmpmee_millerrabin_safe_search_fread(search, stream, 20));
+  fclose(stream);
+  gmpmee_millerrabin_safe_search_clear(search);
+
+  mpz_clear(expected);
+  mpz_clear(end);
+  mpz_clear(start);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies that hash-derived bases are deterministic and that the
+ * tests and searches using them agree with GMP and do not depend on
+ * the number of threads.
+ */
+void
+test_miller_rabin_hs(long test_time)
+{
+  int t;
+  size_t i;
+  size_t len = 16;
+  int results[16];
+  int mt_results[16];
+  unsigned char seed[GMPMEE_HASH_SEED_BYTES];
+  gmp_randstate_t rstate;
+  mpz_t n;
+  mpz_t base;
+  mpz_t base2;
+  mpz_t rop;
+  mpz_t mt_rop;
+  mpz_t *cands;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(base);
+  mpz_init(base2);
+  mpz_init(rop);
+  mpz_init(mt_rop);
+  cands = gmpmee_array_alloc_init(len);
+
+  for (i = 0; i < GMPMEE_HASH_SEED_BYTES; i++)
+    {
+      seed[i] = (unsigned char)gmp_urandomm_ui(rstate, 256);
+    }
+
+  t = clock();
+  do
+    {
+      /* Bases are deterministic, in range, and differ between rounds
+	 and seeds. */
+      mpz_urandomb(n, rstate, 8 + gmp_urandomm_ui(rstate, 1000));
+      mpz_setbit(n, 3);
+      gmpmee_millerrabin_hash_base(base, seed, n, 7);
+      gmpmee_millerrabin_hash_base(base2, seed, n, 7);
+      assert(mpz_cmp(base, base2) == 0);
+      assert(mpz_cmp_ui(base, 2) >= 0);
+      mpz_sub_ui(base2, n, 2);
+      assert(mpz_cmp(base, base2) <= 0);
+      if (mpz_sizeinbase(n, 2) > 64)
+	{
+	  gmpmee_millerrabin_hash_base(base2, seed, n, 8);
+	  assert(mpz_cmp(base, base2) != 0);
+	  seed[0] ^= 1;
+	  gmpmee_millerrabin_hash_base(base2, seed, n, 7);
+	  assert(mpz_cmp(base, base2) != 0);
+	  seed[0] ^= 1;
+	}
+
+      /* Primality and safe-primality tests. */
+      assert(gmpmee_millerrabin_hs(seed, n, 20)
+	     == (mpz_probab_prime_p(n, 25) > 0));
+      mpz_nextprime(n, n);
+      assert(gmpmee_millerrabin_hs(seed, n, 20) == 1);
+
+      mpz_urandomb(n, rstate, 64 + gmp_urandomm_ui(rstate, 200));
+      gmpmee_millerrabin_safe_next_hs(rop, seed, n, 20);
+      gmpmee_millerrabin_safe_next_mt_hs(mt_rop, seed, n, 20, 4);
+      assert(mpz_cmp(rop, mt_rop) == 0);
+      assert(gmpmee_millerrabin_safe_hs(seed, rop, 20) == 1);
+      assert(mpz_probab_safe_prime_p(rop, 20));
+
+      /* Searches and arrays do not depend on the number of threads. */
+      mpz_urandomb(n, rstate, 500 + gmp_urandomm_ui(rstate, 600));
+      gmpmee_millerrabin_next_hs(rop, seed, n, 20);
+      gmpmee_millerrabin_next_mt_hs(mt_rop, seed, n, 20, 4);
+      mpz_nextprime(n, n);
+      assert(mpz_cmp(rop, n) == 0);
+      assert(mpz_cmp(mt_rop, n) == 0);
+
+      for (i = 0; i < len; i++)
+	{
+	  mpz_urandomb(cands[i], rstate, 512 + gmp_urandomm_ui(rstate, 256));
+	  if (i % 4 == 0)
+	    {
+	      mpz_nextprime(cands[i], cands[i]);
+	    }
+	}
+      gmpmee_millerrabin_array_hs(results, seed, cands, len, 20, 1);
+      gmpmee_millerrabin_array_hs(mt_results, seed, cands, len, 20, 3);
+      for (i = 0; i < len; i++)
+	{
+	  assert(results[i] == mt_results[i]);
+	  assert(results[i] == (mpz_probab_prime_p(cands[i], 25) > 0));
+	}
+    }
+  while (!gmpmee_done(t, test_time));
+
+  gmpmee_array_clear_dealloc(cands, len);
+  mpz_clear(mt_rop);
+  mpz_clear(rop);
+  mpz_clear(base2);
+  mpz_clear(base);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies that consecutive primes found from a single sieve agree
+ * with GMP's search for the next prime.
+ */
+void
+test_miller_rabin_next_k(long test_time)
+{
+  int t;
+  size_t i;
+  size_t k;
+  size_t len = 64;
+  unsigned int nthreads;
+  gmp_randstate_t rstate;
+  mpz_t *rops;
+  mpz_t n;
+  mpz_t p;
+
+  gmp_randinit_default(rstate);
+  rops = gmpmee_array_alloc_init(len);
+  mpz_init(n);
+  mpz_init(p);
+
+  /* Small starting points. */
+  for (i = 0; i < 40; i++)
+    {
+      mpz_set_ui(n, i);
+      gmpmee_millerrabin_next_k_rs(rops, len, rstate, n, 20);
+      mpz_set(p, n);
+      for (k = 0; k < len; k++)
+	{
+	  mpz_nextprime(p, p);
+	  assert(mpz_cmp(rops[k], p) == 0);
+	}
+    }
+
+  t = clock();
+  do
+    {
+      mpz_urandomb(n, rstate, 2 + gmp_urandomm_ui(rstate, 700));
+      k = 1 + gmp_urandomm_ui(rstate, len);
+      nthreads = 1 + gmp_urandomm_ui(rstate, 4);
+      gmpmee_millerrabin_next_k_mt_rs(rops, k, rstate, n, 20, nthreads);
+
+      mpz_set(p, n);
+      for (i = 0; i < k; i++)
+	{
+	  mpz_nextprime(p, p);
+	  assert(mpz_cmp(rops[i], p) == 0);
+	}
+    }
+  while (!gmpmee_done(t, test_time));
+
+  mpz_clear(p);
+  mpz_clear(n);
+  gmpmee_array_clear_dealloc(rops, len);
+  gmp_randclear(rstate);
+}
+
 void
 test_miller_rabin(int call, long test_time)
 {
@@ -102,6 +1314,235 @@ test_miller_rabin(int call, long test_time)
   gmp_randclear(rstate);
 }
 
+/*
+ * Verifies that the subgroup search outputs the smallest prime of the
+ * form kq + 1 larger than the starting point.
+ */
+void
+test_miller_rabin_subgroup(long test_time)
+{
+  int t;
+  int reps = 20;
+  gmp_randstate_t rstate;
+  mpz_t n;
+  mpz_t q;
+  mpz_t p;
+  mpz_t k;
+  mpz_t c;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(q);
+  mpz_init(p);
+  mpz_init(k);
+  mpz_init(c);
+  t = clock();
+
+  do
+    {
+      /* Small and even orders and starting points smaller than the
+         order are included. */
+      mpz_urandomb(q, rstate, 1 + gmp_urandomm_ui(rstate, 160));
+      mpz_nextprime(q, q);
+      mpz_urandomb(n, rstate, 1 + gmp_urandomm_ui(rstate, 300));
+
+      gmpmee_millerrabin_subgroup_next_rs(p, rstate, n, q, reps);
+
+      assert(mpz_cmp(p, n) > 0);
+      assert(mpz_probab_prime_p(p, reps) > 0);
+      mpz_sub_ui(k, p, 1);
+      assert(mpz_divisible_p(k, q));
+
+      /* No integer kq + 1 in (n, p) is prime. */
+      mpz_set(c, k);
+      for (mpz_sub(c, c, q); mpz_cmp(c, n) >= 0; mpz_sub(c, c, q))
+        {
+          mpz_add_ui(c, c, 1);
+          assert(mpz_probab_prime_p(c, reps) == 0);
+          mpz_sub_ui(c, c, 1);
+        }
+    }
+  while (!gmpmee_done(t, test_time));
+
+  /* With q = 1 the result is the next prime, including 2. */
+  mpz_set_ui(q, 1);
+  for (mpz_set_si(n, -3); mpz_cmp_ui(n, 20) < 0; mpz_add_ui(n, n, 1))
+    {
+      gmpmee_millerrabin_subgroup_next_rs(p, rstate, n, q, reps);
+      mpz_nextprime(c, n);
+      assert(mpz_cmp(p, c) == 0);
+    }
+
+  mpz_clear(c);
+  mpz_clear(k);
+  mpz_clear(p);
+  mpz_clear(q);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies that random (safe) primes have the requested bit length.
+ */
+void
+test_random_prime(long test_time)
+{
+  int t;
+  int reps = 20;
+  unsigned long int bits;
+  gmp_randstate_t rstate;
+  mpz_t p;
+  mpz_t m;
+
+  gmp_randinit_default(rstate);
+  mpz_init(p);
+  mpz_init(m);
+  t = clock();
+
+  do
+    {
+      bits = 2 + gmp_urandomm_ui(rstate, 300);
+      gmpmee_random_prime_mt_rs(p, rstate, bits, reps, 1 + bits % 3);
+      assert(mpz_sizeinbase(p, 2) == bits);
+      assert(mpz_probab_prime_p(p, reps) > 0);
+
+      bits = 3 + gmp_urandomm_ui(rstate, 100);
+      gmpmee_random_safe_prime_mt_rs(p, rstate, bits, reps, 1 + bits % 3);
+      assert(mpz_sizeinbase(p, 2) == bits);
+      mpz_tdiv_q_2exp(m, p, 1);
+      assert(mpz_probab_prime_p(p, reps) > 0);
+      assert(mpz_probab_prime_p(m, reps) > 0);
+    }
+  while (!gmpmee_done(t, test_time));
+
+  /* Threads are only used for large candidates. */
+  gmpmee_random_prime_rs(p, rstate, 1024, reps);
+  assert(mpz_sizeinbase(p, 2) == 1024);
+  gmpmee_random_prime_mt_rs(p, rstate, 1024, reps, 3);
+  assert(mpz_sizeinbase(p, 2) == 1024);
+  assert(mpz_probab_prime_p(p, reps) > 0);
+  gmpmee_random_safe_prime_rs(p, rstate, 4, reps);
+  assert(mpz_cmp_ui(p, 11) == 0);
+
+  mpz_clear(m);
+  mpz_clear(p);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Verifies that multi-threaded searches give the same result as
+ * single-threaded searches.
+ */
+void
+test_miller_rabin_mt(long test_time)
+{
+  int t;
+  size_t i;
+  unsigned int iter = 0;
+  int reps = 20;
+  int bit_length = GMPMEE_SEARCH_MT_MIN_BITLEN;
+  size_t len = 40;
+  int *results;
+  int *hs_results;
+  unsigned char seed[GMPMEE_HASH_SEED_BYTES];
+  mpz_t *candidates;
+  gmp_randstate_t rstate;
+  mpz_t n;
+  mpz_t q;
+  mpz_t rop;
+  mpz_t mtrop;
+
+  gmp_randinit_default(rstate);
+  mpz_init(n);
+  mpz_init(q);
+  mpz_init(rop);
+  mpz_init(mtrop);
+
+  /* Arrays of small integers are tested by a single thread. */
+  results = (int *)malloc(len * sizeof(int));
+  hs_results = (int *)malloc(len * sizeof(int));
+  candidates = gmpmee_array_alloc_init(len);
+  for (i = 0; i < len; i++)
+    {
+      mpz_set_ui(candidates[i], i);
+    }
+  gmpmee_millerrabin_array_rs(results, rstate, candidates, len, reps, 3);
+  for (i = 0; i < len; i++)
+    {
+      assert(results[i] == (mpz_probab_prime_p(candidates[i], reps) > 0));
+    }
+
+  /* Word-sized integers are tested deterministically, so random and
+     hash-derived bases agree, also for strong pseudoprimes to the
+     smallest bases. */
+  for (i = 0; i < len; i++)
+    {
+      mpz_urandomb(candidates[i], rstate, 2 + i % 62);
+      mpz_setbit(candidates[i], 0);
+    }
+  mpz_set_ui(candidates[0], 2047);
+  mpz_set_ui(candidates[1], 3215031751UL);
+  mpz_set_str(candidates[2], "2152302898747", 10);
+  for (i = 0; i < GMPMEE_HASH_SEED_BYTES; i++)
+    {
+      seed[i] = (unsigned char)i;
+    }
+  gmpmee_millerrabin_array_rs(results, rstate, candidates, len, 1, 1);
+  gmpmee_millerrabin_array_hs(hs_results, seed, candidates, len, 1, 1);
+  for (i = 0; i < len; i++)
+    {
+      assert(results[i] == hs_results[i]);
+      assert(results[i] == (mpz_probab_prime_p(candidates[i], 25) > 0));
+    }
+
+  t = clock();
+
+  do
+    {
+      mpz_urandomb(n, rstate, bit_length);
+      mpz_setbit(n, bit_length - 1);
+
+      gmpmee_millerrabin_next_rs(rop, rstate, n, reps);
+      gmpmee_millerrabin_next_mt_rs(mtrop, rstate, n, reps, 3);
+      assert(mpz_cmp(rop, mtrop) == 0);
+
+      gmpmee_millerrabin_safe_next_rs(rop, rstate, n, reps);
+      gmpmee_millerrabin_safe_next_mt_rs(mtrop, rstate, n, reps, 3);
+      assert(mpz_cmp(rop, mtrop) == 0);
+
+      mpz_urandomb(q, rstate, 256);
+      mpz_nextprime(q, q);
+      gmpmee_millerrabin_subgroup_next_rs(rop, rstate, n, q, reps);
+      gmpmee_millerrabin_subgroup_next_mt_rs(mtrop, rstate, n, q, reps, 3);
+      assert(mpz_cmp(rop, mtrop) == 0);
+
+      /* Candidates and primes following n, including more threads
+         than candidates. */
+      mpz_set(candidates[0], n);
+      for (i = 1; i < len; i++)
+        {
+          mpz_add_ui(candidates[i], candidates[i - 1], 2);
+        }
+      mpz_set(candidates[len - 1], rop);
+      gmpmee_millerrabin_array_rs(results, rstate, candidates, len, reps,
+                                  1 + (iter++ % 3) * 30);
+      for (i = 0; i < len; i++)
+        {
+          assert(results[i] == (mpz_probab_prime_p(candidates[i], reps) > 0));
+        }
+    }
+  while (!gmpmee_done(t, test_time));
+
+  gmpmee_array_clear_dealloc(candidates, len);
+  free(hs_results);
+  free(results);
+  mpz_clear(mtrop);
+  mpz_clear(rop);
+  mpz_clear(q);
+  mpz_clear(n);
+  gmp_randclear(rstate);
+}
+
 void
 test_spowm_modulus_bitlen(int modulus_bitlen)
 {
@@ -284,6 +1725,93 @@ test_fpowm(long test_time)
 
 }
 
+void
+test_array_import_export_endian(gmp_randstate_t state, mpz_t *a, size_t len,
+                                size_t size, int endian)
+{
+  size_t i;
+  unsigned char *buf;
+  mpz_t *b;
+  FILE *stream;
+
+  buf = (unsigned char *)malloc(len * size);
+  b = gmpmee_array_alloc_init(len);
+
+  /* Integers of at most size bytes, including zero. */
+  gmpmee_array_urandomb(a, len, state, 8 * size);
+  mpz_set_ui(a[0], 0);
+
+  /* Contiguous buffer. */
+  assert(gmpmee_array_export(buf, a, len, size, endian) == len);
+  gmpmee_array_import(b, len, buf, size, endian);
+  for (i = 0; i < len; i++)
+    {
+      assert(mpz_cmp(a[i], b[i]) == 0);
+    }
+
+  /* Stream. */
+  stream = tmpfile();
+  assert(stream != NULL);
+  assert(gmpmee_array_fwrite(stream, a, len, size, endian) == len);
+  rewind(stream);
+  gmpmee_array_urandomb(b, len, state, 8 * size);
+  assert(gmpmee_array_fread(b, len, size, endian, stream) == len);
+  for (i = 0; i < len; i++)
+    {
+      assert(mpz_cmp(a[i], b[i]) == 0);
+    }
+
+  /* Reading past the end stops at the end. */
+  assert(gmpmee_array_fread(b, 1, size, endian, stream) == 0);
+  fclose(stream);
+
+  /* Integers that are too large are not exported. */
+  mpz_setbit(a[len / 2], 8 * size);
+  assert(gmpmee_array_export(buf, a, len, size, endian) == len / 2);
+
+  gmpmee_array_clear_dealloc(b, len);
+  free(buf);
+}
+
+void
+test_array_import_export()
+{
+  size_t size;
+  size_t len = 3 * GMPMEE_ARRAY_CHUNK_BYTES / 128 + 1;
+  unsigned char buf[4];
+  gmp_randstate_t state;
+  FILE *stream;
+  mpz_t *a;
+
+  gmp_randinit_default(state);
+  a = gmpmee_array_alloc_init(len);
+
+  /* Explicit byte order. */
+  mpz_set_ui(a[0], 0x0102);
+  assert(gmpmee_array_export(buf, a, 1, 4, GMPMEE_BIG_ENDIAN) == 1);
+  assert(buf[0] == 0 && buf[1] == 0 && buf[2] == 1 && buf[3] == 2);
+  assert(gmpmee_array_export(buf, a, 1, 4, GMPMEE_LITTLE_ENDIAN) == 1);
+  assert(buf[0] == 2 && buf[1] == 1 && buf[2] == 0 && buf[3] == 0);
+
+  for (size = 1; size <= 256; size *= 2)
+    {
+      test_array_import_export_endian(state, a, len, size, GMPMEE_BIG_ENDIAN);
+      test_array_import_export_endian(state, a, len, size,
+                                      GMPMEE_LITTLE_ENDIAN);
+    }
+
+  /* Integers of zero bytes are rejected without using the stream. */
+  stream = tmpfile();
+  assert(stream != NULL);
+  assert(gmpmee_array_fwrite(stream, a, len, 0, GMPMEE_BIG_ENDIAN) == 0);
+  assert(ftell(stream) == 0);
+  assert(gmpmee_array_fread(a, len, 0, GMPMEE_BIG_ENDIAN, stream) == 0);
+  fclose(stream);
+
+  gmpmee_array_clear_dealloc(a, len);
+  gmp_randclear(state);
+}
+
 /* LCOV_EXCL_START */
 void
 usage(char *command_name) {
@@ -291,6 +1819,249 @@ usage(char *command_name) {
 }
 /* LCOV_EXCL_STOP */
 
+void
+test_stats()
+{
+  int i;
+  mpz_t modulus;
+  mpz_t rop;
+  mpz_t *bases;
+  mpz_t *exponents;
+  mpz_t *primes;
+  int results[2];
+  gmpmee_fpowm_tab table;
+  gmpmee_stats stats;
+  gmpmee_stats op;
+  gmp_randstate_t rstate;
+
+  gmp_randinit_default(rstate);
+  mpz_init(modulus);
+  mpz_init(rop);
+  bases = gmpmee_array_alloc_init(3);
+  exponents = gmpmee_array_alloc_init(3);
+  primes = gmpmee_array_alloc_init(2);
+
+  mpz_urandomb(modulus, rstate, 256);
+  mpz_setbit(modulus, 255);
+  mpz_setbit(modulus, 0);
+  for (i = 0; i < 3; i++)
+    {
+      mpz_urandomb(bases[i], rstate, 255);
+      mpz_urandomb(exponents[i], rstate, 99);
+      mpz_setbit(exponents[i], 99);
+    }
+
+  /* Blocks of width two and one give a single non-trivial
+     multiplication during precomputation, 100 squarings and 2 * 100
+     multiplications during evaluation, and a final multiplication.
+     The modulus is odd, so there are also conversions into
+     Montgomery representation of one when the table is initialized
+     and of the 3 bases during precomputation, and one out of it after
+     evaluation. Only the Montgomery table of 2 * 2^2 entries is
+     allocated. */
+  gmpmee_stats_reset();
+  gmpmee_spowm_block_batch(rop, bases, exponents, 3, modulus, 2, 3);
+  gmpmee_stats_get(stats);
+  if (gmpmee_stats_enabled())
+    {
+      assert(stats->sqr == 100);
+      assert(stats->mul == 1 + 200 + 1);
+      assert(stats->redc == stats->sqr + stats->mul + 1 + 3 + 1);
+      assert(stats->block_width == 2);
+      assert(stats->batch_len == 3);
+      assert(stats->table_bytes
+             == (2 << 2) * mpz_size(modulus) * sizeof(mp_limb_t));
+      assert(stats->precomp_seconds >= 0 && stats->eval_seconds >= 0);
+    }
+  else
+    {
+      assert(stats->sqr == 0 && stats->mul == 0 && stats->redc == 0);
+      assert(stats->table_bytes == 0 && stats->block_width == 0);
+    }
+
+  /* Three bases squared 16 times each and 11 non-trivial
+     multiplications during precomputation, and 16 squarings and
+     multiplications during evaluation, since the exponent is split
+     into four parts. */
+  gmpmee_stats_reset();
+  gmpmee_fpowm_init_precomp(table, bases[0], modulus, 4, 64);
+  mpz_urandomb(exponents[0], rstate, 63);
+  mpz_setbit(exponents[0], 63);
+  gmpmee_fpowm(rop, table, exponents[0]);
+  gmpmee_fpowm_clear(table);
+  gmpmee_stats_get(stats);
+  if (gmpmee_stats_enabled())
+    {
+      assert(stats->powm == 0);
+      assert(stats->sqr == 3 * 16 + 16);
+      assert(stats->mul == 11 + 16);
+      assert(stats->block_width == 4 && stats->batch_len == 4);
+    }
+
+  /* Rounds executed by threads are added to the counters of the
+     caller. */
+  mpz_set_ui(primes[0], 0);
+  mpz_setbit(primes[0], 521);
+  mpz_sub_ui(primes[0], primes[0], 1);
+  mpz_set(primes[1], primes[0]);
+  gmpmee_stats_reset();
+  gmpmee_millerrabin_array_rs(results, rstate, primes, 2, 3, 2);
+  assert(results[0] && results[1]);
+  gmpmee_stats_get(stats);
+  if (gmpmee_stats_enabled())
+    {
+      assert(stats->mr_rounds == 6);
+    }
+
+  /* Counters are added and parameters replaced. */
+  memset(op, 0, sizeof(gmpmee_stats_struct));
+  op->sqr = 1;
+  op->table_bytes = 1;
+  op->block_width = 7;
+  op->batch_len = 9;
+  gmpmee_stats_get(stats);
+  gmpmee_stats_add(op);
+  gmpmee_stats_get(op);
+  if (gmpmee_stats_enabled())
+    {
+      assert(op->sqr == stats->sqr + 1);
+      assert(op->table_bytes == (stats->table_bytes > 1 ?
+				 stats->table_bytes : 1));
+      assert(op->block_width == 7 && op->batch_len == 9);
+    }
+  else
+    {
+      assert(op->sqr == 0 && op->block_width == 0);
+    }
+  gmpmee_stats_reset();
+
+  gmpmee_array_clear_dealloc(primes, 2);
+  gmpmee_array_clear_dealloc(exponents, 3);
+  gmpmee_array_clear_dealloc(bases, 3);
+  mpz_clear(rop);
+  mpz_clear(modulus);
+  gmp_randclear(rstate);
+}
+
+/*
+ * Records of the traced calls of test_trace.
+ */
+#define TEST_TRACE_MAX 8
+static gmpmee_trace_record_struct test_trace_records[TEST_TRACE_MAX];
+static size_t test_trace_len;
+
+static void
+test_trace_callback(gmpmee_trace_record_struct *record, void *arg)
+{
+  assert(arg == &test_trace_len);
+  assert(test_trace_len < TEST_TRACE_MAX);
+  test_trace_records[test_trace_len++] = *record;
+}
+
+void
+test_trace()
+{
+  int i;
+  FILE *stream;
+  mpz_t modulus;
+  mpz_t rop;
+  mpz_t *bases;
+  mpz_t *exponents;
+  gmpmee_spowm_tab stab;
+  gmpmee_fpowm_tab ftab;
+  gmpmee_trace_record record;
+  gmp_randstate_t rstate;
+
+  gmp_randinit_default(rstate);
+  mpz_init(modulus);
+  mpz_init(rop);
+  bases = gmpmee_array_alloc_init(5);
+  exponents = gmpmee_array_alloc_init(5);
+
+  mpz_urandomb(modulus, rstate, 512);
+  mpz_setbit(modulus, 511);
+  for (i = 0; i < 5; i++)
+    {
+      mpz_urandomm(bases[i], rstate, modulus);
+      mpz_urandomb(exponents[i], rstate, 100 + i);
+      mpz_setbit(exponents[i], 99 + i);
+    }
+
+  /* Nothing is recorded before a callback is registered. */
+  test_trace_len = 0;
+  gmpmee_spowm(rop, bases, exponents, 5, modulus);
+  gmpmee_trace_set(test_trace_callback, &test_trace_len);
+
+  /* Calls made by a traced call are not recorded. */
+  gmpmee_spowm(rop, bases, exponents, 5, modulus);
+  gmpmee_spowm_block_batch(rop, bases, exponents, 5, modulus, 3, 4);
+  gmpmee_spowm_init(stab, 5, modulus, 2);
+  gmpmee_spowm_precomp(stab, bases);
+  gmpmee_spowm_table(rop, stab, exponents);
+  gmpmee_spowm_clear(stab);
+  gmpmee_fpowm_init_precomp(ftab, bases[0], modulus, 4, 200);
+  gmpmee_fpowm(exponents[0], ftab, exponents[0]);
+  gmpmee_fpowm_clear(ftab);
+
+  gmpmee_trace_set(NULL, NULL);
+  gmpmee_spowm(rop, bases, exponents, 5, modulus);
+
+  assert(test_trace_len == 6);
+  assert(test_trace_records[0].op == GMPMEE_TRACE_SPOWM);
+  assert(test_trace_records[1].op == GMPMEE_TRACE_SPOWM_BLOCK_BATCH);
+  assert(test_trace_records[2].op == GMPMEE_TRACE_SPOWM_PRECOMP);
+  assert(test_trace_records[3].op == GMPMEE_TRACE_SPOWM_TABLE);
+  assert(test_trace_records[4].op == GMPMEE_TRACE_FPOWM_PRECOMP);
+  assert(test_trace_records[5].op == GMPMEE_TRACE_FPOWM);
+  for (i = 0; i < 6; i++)
+    {
+      assert(test_trace_records[i].modulus_bitlen == 512);
+      assert(test_trace_records[i].seconds >= 0);
+    }
+  assert(test_trace_records[0].len == 5);
+  assert(test_trace_records[0].exponent_bitlen == 104);
+  assert(test_trace_records[0].block_width == 5);
+  assert(test_trace_records[0].batch_len == 5);
+  assert(test_trace_records[1].block_width == 3);
+  assert(test_trace_records[1].batch_len == 4);
+  assert(test_trace_records[2].exponent_bitlen == 0);
+  assert(test_trace_records[3].block_width == 2);
+  assert(test_trace_records[4].block_width == 4);
+  assert(test_trace_records[4].batch_len == 200);
+  assert(test_trace_records[5].exponent_bitlen == 100);
+
+  /* Records are written and read as text. */
+  stream = tmpfile();
+  fprintf(stream, "# Trace\n\n");
+  for (i = 0; i < 6; i++)
+    {
+      gmpmee_trace_fprint(&test_trace_records[i], stream);
+    }
+  fprintf(stream, "unknown 1 2 3 4 5 6\n");
+  rewind(stream);
+  for (i = 0; i < 6; i++)
+    {
+      assert(gmpmee_trace_fread(record, stream));
+      assert(record->op == test_trace_records[i].op);
+      assert(record->len == test_trace_records[i].len);
+      assert(record->exponent_bitlen
+	     == test_trace_records[i].exponent_bitlen);
+      assert(record->batch_len == test_trace_records[i].batch_len);
+    }
+  assert(!gmpmee_trace_fread(record, stream));
+  assert(!feof(stream));
+  fclose(stream);
+
+  assert(gmpmee_trace_name(0) == NULL);
+  assert(gmpmee_trace_name(GMPMEE_TRACE_OPS) == NULL);
+
+  gmpmee_array_clear_dealloc(exponents, 5);
+  gmpmee_array_clear_dealloc(bases, 5);
+  mpz_clear(rop);
+  mpz_clear(modulus);
+  gmp_randclear(rstate);
+}
+
 int
 main(int args, char *argv[])
 {
@@ -323,6 +2094,38 @@ main(int args, char *argv[])
   test_fpowm(ms);
   printf("done.\n");
 
+  printf("Testing array import and export... ");
+  test_array_import_export();
+  printf("done.\n");
+
+  printf("Testing sieve... ");
+  test_sieve();
+  printf("done.\n");
+
+  printf("Testing trial division... ");
+  test_trial();
+  printf("done.\n");
+
+  printf("Testing Montgomery arithmetic... ");
+  test_mont();
+  printf("done.\n");
+
+  printf("Testing Montgomery kernels (%s)... ", gmpmee_kernels->name);
+  test_kernels();
+  printf("done.\n");
+
+  printf("Testing multi-lane exponentiation (%u lanes)... ", gmpmee_lanes());
+  test_lanes();
+  printf("done.\n");
+
+  printf("Testing native Miller-Rabin (%ld ms)... ", ms);
+  test_miller_rabin_ui(ms);
+  printf("done.\n");
+
+  printf("Testing Baillie-PSW (%ld ms)... ", ms);
+  test_miller_rabin_bpsw(ms);
+  printf("done.\n");
+
   printf("Testing Miller-Rabin (%ld ms)... ", ms);
   test_miller_rabin(0, ms);
   printf("done.\n");
@@ -337,6 +2140,43 @@ main(int args, char *argv[])
 
   printf("Testing Miller-Rabin next safe prime (%ld ms)... ", ms);
   test_miller_rabin(3, ms);
+  printf("done.\n");
+
+  printf("Testing Miller-Rabin next k primes (%ld ms)... ", ms);
+  test_miller_rabin_next_k(ms);
+  printf("done.\n");
+
+  printf("Testing hash-derived Miller-Rabin bases (%ld ms)... ", ms);
+  test_miller_rabin_hs(ms);
+  printf("done.\n");
+
+  printf("Testing Miller-Rabin error targets (%ld ms)... ", ms);
+  test_miller_rabin_error(ms);
+  printf("done.\n");
+
+  printf("Testing resumable safe-prime search (%ld ms)... ", ms);
+  test_miller_rabin_safe_search(ms);
+  printf("done.\n");
+
+  printf("Testing Miller-Rabin subgroup prime (%ld ms)... ", ms);
+  test_miller_rabin_subgroup(ms);
+  printf("done.\n");
+
+  printf("Testing random (safe) primes (%ld ms)... ", ms);
+  test_random_prime(ms);
+  printf("done.\n");
+
+  printf("Testing multi-threaded searches (%ld ms)... ", ms);
+  test_miller_rabin_mt(ms);
+  printf("done.\n");
+
+  printf("Testing operation counters (%s)... ",
+         gmpmee_stats_enabled() ? "enabled" : "disabled");
+  test_stats();
+  printf("done.\n");
+
+  printf("Testing tracing... ");
+  test_trace();
   printf("done.\n\n");
 
   exit(0);
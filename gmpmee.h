@@ -106,6 +106,7 @@
 #define GMPMEE_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <gmp.h>
 
 /**
@@ -118,21 +119,257 @@
 #define GMPMEE_UNUSED(x) ((void)(x))
 
 
+/* #################### Montgomery Arithmetic #################### */
+
+/**
+ * Context for Montgomery multiplication modulo an odd integer
+ * <i>m</i> of <i>n</i> limbs. Elements are represented by
+ * <i>n</i>-limb arrays holding <i>aR</i> mod <i>m</i>, where
+ * <i>R</i>=2^(<i>n</i>*GMP_NUMB_BITS). All buffers are kept when
+ * the modulus is replaced by one that is not longer, so a context
+ * can be reused for a sequence of candidate primes without
+ * reallocation.
+ */
+typedef struct
+{
+  mpz_t modulus;        /**< Modulus, or zero if undefined. */
+  mp_size_t size;       /**< Number of limbs of the modulus, or zero. */
+  mp_size_t alloc;      /**< Number of limbs allocated per element. */
+  mp_limb_t minv;       /**< -1/m mod 2^GMP_NUMB_BITS. */
+  mp_limb_t *mp;        /**< Limbs of the modulus. */
+  mp_limb_t *one;       /**< Representation of one. */
+  mp_limb_t *minus_one; /**< Representation of minus one. */
+  mp_limb_t *xp;        /**< Temporary element. */
+  mp_limb_t *tp;        /**< Temporary space of twice the size. */
+  mpz_t tmp;            /**< Temporary integer. */
+} gmpmee_mont_struct;
+
+/**
+ * Montgomery multiplication context.
+ */
+typedef gmpmee_mont_struct gmpmee_mont[1]; /* Magic references. */
+
+/**
+ * Pointer to a Montgomery multiplication context.
+ */
+typedef gmpmee_mont_struct *gmpmee_mont_ptr;
+
+/**
+ * Initializes a context with an undefined modulus.
+ *
+ * @param mont Context.
+ */
+void
+gmpmee_mont_init(gmpmee_mont mont);
+
+/**
+ * Sets the modulus of the context. If the modulus is even or smaller
+ * than three, then the modulus is left undefined, i.e., the size of
+ * the context is set to zero.
+ *
+ * @param mont Context.
+ * @param modulus Modulus.
+ */
+void
+gmpmee_mont_set(gmpmee_mont mont, mpz_t modulus);
+
+/**
+ * Frees the memory allocated by the context.
+ *
+ * @param mont Context.
+ */
+void
+gmpmee_mont_clear(gmpmee_mont mont);
+
+/**
+ * Writes the absolute value of the integer as an array of the given
+ * number of limbs with the least significant limb first. The integer
+ * must fit in the array.
+ *
+ * @param rp Destination.
+ * @param op Integer.
+ * @param size Number of limbs in the destination.
+ */
+void
+gmpmee_mont_limbs(mp_limb_t *rp, mpz_t op, mp_size_t size);
+
+/**
+ * Montgomery reduction. Sets <i>rp</i> to <i>tR</i>^(-1) mod
+ * <i>m</i>, where <i>t</i> is given by the 2<i>n</i> limbs of
+ * <i>tp</i> and must be smaller than <i>mR</i>. The input is
+ * destroyed and must not overlap with the output or the temporary
+ * space of the context.
+ *
+ * @param rp Destination of <i>n</i> limbs.
+ * @param tp Input of 2<i>n</i> limbs.
+ * @param mont Context.
+ */
+void
+gmpmee_mont_redc(mp_limb_t *rp, mp_limb_t *tp, gmpmee_mont mont);
+
+/**
+ * Montgomery multiplication. The destination may coincide with the
+ * inputs.
+ *
+ * @param rp Destination.
+ * @param ap First factor.
+ * @param bp Second factor.
+ * @param mont Context.
+ */
+void
+gmpmee_mont_mul(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *bp,
+		gmpmee_mont mont);
+
+/**
+ * Montgomery squaring. The destination may coincide with the input.
+ *
+ * @param rp Destination.
+ * @param ap Input.
+ * @param mont Context.
+ */
+void
+gmpmee_mont_sqr(mp_limb_t *rp, const mp_limb_t *ap, gmpmee_mont mont);
+
+/**
+ * Converts a non-negative integer to Montgomery representation.
+ *
+ * @param rp Destination.
+ * @param op Integer.
+ * @param mont Context.
+ */
+void
+gmpmee_mont_to(mp_limb_t *rp, mpz_t op, gmpmee_mont mont);
+
+/**
+ * Converts an element in Montgomery representation to an integer in
+ * [0,<i>m</i>-1].
+ *
+ * @param rop Destination.
+ * @param ap Element.
+ * @param mont Context.
+ */
+void
+gmpmee_mont_from(mpz_t rop, const mp_limb_t *ap, gmpmee_mont mont);
+
+
+/* #################### Montgomery Kernels #################### */
+
+#if defined(__x86_64__) && defined(__GNUC__) && GMP_NUMB_BITS == 64 \
+  && GMP_NAIL_BITS == 0
+/**
+ * Defined if the library is compiled with the Montgomery kernels
+ * based on the BMI2 and ADX instructions, which are only used if
+ * the processor supports them.
+ */
+#define GMPMEE_HAVE_ADX 1
+#endif
+
+/**
+ * Implementation of Montgomery reduction, multiplication, and
+ * squaring modulo an odd modulus <i>m</i> of <i>n</i> limbs, where
+ * <i>minv</i> is -1/<i>m</i> mod 2^GMP_NUMB_BITS. The functions have
+ * the semantics of gmpmee_mont_redc, gmpmee_mont_mul, and
+ * gmpmee_mont_sqr, but take the modulus and a temporary space
+ * <i>tp</i> of 2<i>n</i> limbs explicitly, so they can be called
+ * concurrently with the same modulus.
+ */
+typedef struct
+{
+  const char *name;  /**< Name of the kernels. */
+  void (*redc)(mp_limb_t *rp, mp_limb_t *tp,
+	       const mp_limb_t *mp, mp_size_t n, mp_limb_t minv);
+                     /**< Montgomery reduction. */
+  void (*mul)(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *bp,
+	      const mp_limb_t *mp, mp_size_t n, mp_limb_t minv,
+	      mp_limb_t *tp);
+                     /**< Montgomery multiplication. */
+  void (*sqr)(mp_limb_t *rp, const mp_limb_t *ap,
+	      const mp_limb_t *mp, mp_size_t n, mp_limb_t minv,
+	      mp_limb_t *tp);
+                     /**< Montgomery squaring. */
+} gmpmee_kernels_struct;
+
+/**
+ * Portable kernels based on the mpn functions of GMP.
+ */
+extern const gmpmee_kernels_struct gmpmee_kernels_generic;
+
+#ifdef GMPMEE_HAVE_ADX
+/**
+ * Kernels that interleave two carry chains in the reduction using
+ * the mulx, adcx, and adox instructions.
+ */
+extern const gmpmee_kernels_struct gmpmee_kernels_adx;
+#endif
+
+/**
+ * Kernels called by the Montgomery arithmetic, and by the
+ * simultaneous and fixed-base exponentiation routines for odd
+ * moduli. When the library is loaded, this is set to the fastest
+ * kernels supported by the processor, unless the environment
+ * variable GMPMEE_KERNELS names other supported kernels.
+ */
+extern const gmpmee_kernels_struct *gmpmee_kernels;
+
+/**
+ * Returns the kernels with the given name, or the fastest kernels
+ * if the name is NULL. NULL is returned if there are no kernels with
+ * the name, or if they are not supported by the processor.
+ *
+ * @param name Name of kernels, or NULL.
+ * @return Kernels or NULL.
+ */
+const gmpmee_kernels_struct *
+gmpmee_kernels_lookup(const char *name);
+
+/**
+ * Replaces the kernels called by the Montgomery arithmetic by the
+ * kernels with the given name, if they are supported by the
+ * processor. This is not thread safe and is only meant for testing
+ * and benchmarking.
+ *
+ * @param name Name of kernels.
+ * @return 1 if the kernels were replaced and 0 otherwise.
+ */
+int
+gmpmee_kernels_select(const char *name);
+
+/**
+ * Writes the names of the selected Montgomery kernels and the
+ * multi-lane kernel (see gmpmee_lanes) to the stream, one per line.
+ *
+ * @param stream Destination stream.
+ */
+void
+gmpmee_kernels_fprint(FILE *stream);
+
+
 /* #################### Simultaneous Exponentiation #################### */
 
 
 /**
  * Stores the tables of precomputed products of subsets of the
  * bases. Each table contains the precomputed products for a range of
- * a given width of the bases.
+ * a given width of the bases. If the modulus is odd, then the
+ * products are only kept in Montgomery representation and the
+ * exponentiations are computed by the Montgomery kernels, see
+ * gmpmee_kernels.
  */
 typedef struct
 {
   size_t len;             /**< Total number of bases/exponents. */
   size_t block_width;     /**< Number of bases/exponents in each block. */
   size_t tabs_len;        /**< Number of blocks. */
-  mpz_t **tabs;           /**< Table of tables, one sub-table for each block. */
+  mpz_t **tabs;           /**< Table of tables, one sub-table for each
+			     block, or NULL for odd moduli. */
   mpz_t modulus;          /**< Modulus used in computations. */
+  gmpmee_mont mont;       /**< Montgomery context, which is undefined
+			     for even moduli. */
+  mp_limb_t *mtabs;       /**< Montgomery representations of the
+			     products, where entry <i>j</i> of
+			     sub-table <i>i</i> is found at index
+			     (<i>i</i>*2^block_width+<i>j</i>)*mont->size,
+			     or NULL for even moduli. */
 
 } gmpmee_spowm_tab[1]; /* Magic references. */
 
@@ -295,246 +532,2277 @@ gmpmee_fpowm_init_precomp(gmpmee_fpowm_tab table, mpz_t basis,
 void
 gmpmee_fpowm(mpz_t rop, gmpmee_fpowm_tab table, mpz_t exponent);
 
-
-
-/* #################### Primality Testing #################### */
-
 /**
- * Stores state inbetween individual invokations of the Miller-Rabin
- * test and keeps allocated space.
+ * Computes fixed base exponentiations for several exponents using
+ * the given table. This is equivalent to calling gmpmee_fpowm for
+ * each exponent, but if the modulus is odd and the processor
+ * supports a multi-lane kernel (see gmpmee_lanes_select_batch), then
+ * the exponentiations are evaluated in parallel lanes that share the
+ * table.
+ *
+ * @param rops Destinations of results.
+ * @param table Precomputed table representing the basis used.
+ * @param exponents Exponents.
+ * @param len Number of exponents.
  */
-typedef struct
-{
-  mpz_t n;             /**< integer to be tested */
-  mpz_t n_minus_1;     /**< n minus one */
-  mpz_t q;             /**< q is defined by n=q*2^k+1 */
-  unsigned long int k; /**< k is defined by n=q*2^k+1 */
-  mpz_t y;             /**< y is temporary space */
-} gmpmee_millerrabin_state[1]; /* Magic references. */
+void
+gmpmee_fpowm_batch(mpz_t *rops, gmpmee_fpowm_tab table, mpz_t *exponents,
+		   size_t len);
 
+/**
+ * Let op = (x_0,..,x_t), where x_i is a binary string with stretch
+ * number of bits (except that x_t may have more bits) and
+ * t=block_width. This function returns (x_{0,i},...,x_{t,i}), where
+ * x_{j,i} is the ith bit of x_j. Each x_j except x_t is considered as
+ * padded with zeros if i > stretch is asked for. Used internally by
+ * gmpmee_fpowm and gmpmee_fpowm_batch.
+ *
+ * @param op Integer from which bits are derived.
+ * @param index Bit index in each sequence of stretch (or more) bits.
+ * @param block_width Number of integers considered in parallel.
+ * @param stretch Number of bits in each integer.
+ * @return Bits of the given index packed into an integer.
+ */
+int
+gmpmee_fpowm_getbits(mpz_t op, int index, size_t block_width,
+		     size_t stretch);
 
 /**
- * Allocate and initialize Miller-Rabin state using the given integer.
+ * Returns the number of squarings used by gmpmee_fpowm for the
+ * exponent, i.e., the number of bit indices passed to
+ * gmpmee_fpowm_getbits. Used internally by gmpmee_fpowm and
+ * gmpmee_fpowm_batch.
  *
- * @param state State for testing.
- * @param n Integer to test.
+ * @param exponent Exponent.
+ * @param block_width Block width of the table.
+ * @param stretch Stretch of the table.
+ * @return Number of squarings.
  */
-void
-gmpmee_millerrabin_init(gmpmee_millerrabin_state state, mpz_t n);
+size_t
+gmpmee_fpowm_steps(mpz_t exponent, size_t block_width, size_t stretch);
+
+
+
+/* #################### Sieving #################### */
 
 /**
- * Updates the state to correspond to the next larger candidate
- * integer that passes the trial divisions.
- *
- * @param state State for testing primality.
+ * Smallest bound on the sieving primes.
  */
-void
-gmpmee_millerrabin_next_cand(gmpmee_millerrabin_state state);
+#define GMPMEE_SIEVE_MIN_BOUND 1024
 
 /**
- * Free memory resources allocated for testing.
- *
- * @param state State for testing.
+ * Largest bound on the sieving primes.
  */
-void
-gmpmee_millerrabin_clear(gmpmee_millerrabin_state state);
+#define GMPMEE_SIEVE_MAX_BOUND 65536
 
 /**
- * Performs trial divisions and returns 0 or 1 depending on if a small
- * factor of the integer has been found or not. Assumes that the input
- * is greater than three.
- *
- * @param n Integer to test.
+ * Largest bound on the sieving primes of a safe-prime sieve.
  */
-int
-gmpmee_millerrabin_trial(mpz_t n);
+#define GMPMEE_SIEVE_SAFE_MAX_BOUND 1048576
 
 /**
- * Executes one round of the Miller-Rabin test and returns 0 or 1
- * depending on if the tested integer is deemed to be composite or
- * not.
- *
- * @param state State for testing.
+ * Smallest number of offsets in a window of a sieve.
+ */
+#define GMPMEE_SIEVE_MIN_LEN 1024
 
- * @param base Base element used for testing. This must be an integer
- * in [2,n-2].
+/**
+ * Largest number of offsets in a window of a sieve.
  */
-int
-gmpmee_millerrabin_once(gmpmee_millerrabin_state state, mpz_t base);
+#define GMPMEE_SIEVE_MAX_LEN 65536
 
 /**
- * Executes the Miller-Rabin test using randomness from one of GMP's
- * random sources. Assumes that the tested integer is greater than
- * three.
- *
- * @param rstate Source of randomness.
- * @param state State for testing.
- * @param reps Number of repetitions.
+ * Largest number of offsets in a window of a safe-prime sieve.
  */
-int
-gmpmee_millerrabin_reps_rs(gmp_randstate_t rstate,
-			   gmpmee_millerrabin_state state,
-			   int reps);
+#define GMPMEE_SIEVE_SAFE_MAX_LEN 262144
 
 /**
- * Executes a number or repetitions of the Miller-Rabin test using
- * basis derived from the given GMP random source and returns 0 or 1
- * depending on if the tested integer is deemed to be composite or
- * not.
- *
- * <p>
- *
- * WARNING! GMP's random number generators are NOT cryptographically
- * secure.
+ * Stores the state of a sieve that outputs the integers
+ * <i>start + i * step</i>, for <i>i = 0, 1, 2,...</i>, that have no
+ * small odd prime factor. In safe mode, the sieve also removes
+ * every integer <i>n</i> such that <i>(n-1)/2</i> has a small odd
+ * prime factor.
  *
  * <p>
  *
- * @param rstate State of random number generator.
- * @param n Integer to test.
- * @param reps Repetitions of the Miller-Rabin test performed.
+ * The progression is processed in windows of consecutive
+ * offsets. The start is only reduced modulo each sieving prime once,
+ * and then the offset of the next integer in the progression
+ * divisible by each prime is tracked from window to window.
  */
-int
-gmpmee_millerrabin_rs(gmp_randstate_t rstate, mpz_t n, int reps);
+typedef struct
+{
+  mpz_t base;                 /**< Integer at offset zero of the window. */
+  mpz_t step;                 /**< Difference between integers. */
+  size_t len;                 /**< Number of offsets in a window. */
+  size_t index;               /**< Next offset in the window. */
+  unsigned char *window;      /**< Non-zero at offsets with small factors. */
+  size_t primes_len;          /**< Number of sieving primes. */
+  unsigned long int *primes;  /**< Sieving primes. */
+  unsigned long int *offsets; /**< Offset of next multiple of each prime
+				 relative to the next window. */
+  int safe;                   /**< Indicates if this is a safe-prime
+				 sieve. */
+  unsigned long int *safe_offsets; /**< Offset of next integer congruent
+				      to one modulo each prime relative
+				      to the next window. */
+} gmpmee_sieve_struct;
 
 /**
- * Searches for the smallest prime larger than the given
- * integer. Primality testing is done using the Miller-Rabin test
- * using randomness from one of GMP's random sources.
+ * Sieve, see gmpmee_sieve_struct.
+ */
+typedef gmpmee_sieve_struct gmpmee_sieve[1]; /* Magic references. */
+
+/**
+ * Pointer to a sieve, e.g., to store a sieve passed as a parameter.
+ */
+typedef gmpmee_sieve_struct *gmpmee_sieve_ptr;
+
+/**
+ * Returns a newly allocated array of all odd primes less than or
+ * equal to the given bound, in increasing order. The array must be
+ * deallocated using free.
  *
- * @param rop Result destination.
- * @param rstate Source of randomness.
- * @param n Starting point in search.
- * @param reps Number of repetitions.
+ * @param len Destination of the number of primes.
+ * @param bound Upper bound on the primes.
+ * @return Array of primes.
+ */
+unsigned long int *
+gmpmee_small_primes(size_t *len, unsigned long int bound);
+
+/**
+ * Allocates and initializes a sieve for the integers
+ * <i>start + i * step</i> using the odd primes up to the given
+ * bound. The bound is decreased if needed to ensure that no prime,
+ * or in safe mode no safe prime, is ever removed by the sieve.
+ *
+ * @param sieve Sieve to be initialized.
+ * @param start First integer of the progression. This must be
+ * positive.
+ * @param step Difference between consecutive integers. This must be
+ * positive.
+ * @param bound Bound on the sieving primes.
+ * @param safe Determines if the sieve is a safe-prime sieve.
  */
 void
-gmpmee_millerrabin_next_rs(mpz_t rop, gmp_randstate_t rstate,
-			   mpz_t n, int reps);
+gmpmee_sieve_init_bound(gmpmee_sieve sieve, mpz_t start, mpz_t step,
+			unsigned long int bound, int safe);
 
 /**
- * Stores the states needed for using the Miller-Rabin test for
- * testing for safe-primality.
+ * Allocates and initializes a sieve for the integers
+ * <i>start + i * step</i>. The bound on the sieving primes is
+ * chosen based on the bit length of the start, but it is always
+ * smaller than the start, so no prime is ever removed by the sieve.
+ *
+ * @param sieve Sieve to be initialized.
+ * @param start First integer of the progression. This must be
+ * positive.
+ * @param step Difference between consecutive integers. This must be
+ * positive.
  */
-typedef struct
-{
-  /**
-   * State of the integer <i>n</i> to be tested.
-   */
-  gmpmee_millerrabin_state nstate;
+void
+gmpmee_sieve_init(gmpmee_sieve sieve, mpz_t start, mpz_t step);
 
-  /**
-   * State of the integer <i>(n-1)/2</i> to be tested.
-   */
-  gmpmee_millerrabin_state mstate;
+/**
+ * Equivalent to gmpmee_sieve_init, except that the step is given as
+ * an unsigned long.
+ *
+ * @param sieve Sieve to be initialized.
+ * @param start First integer of the progression. This must be
+ * positive.
+ * @param step Difference between consecutive integers. This must be
+ * positive.
+ */
+void
+gmpmee_sieve_init_ui(gmpmee_sieve sieve, mpz_t start, unsigned long int step);
 
-} gmpmee_millerrabin_safe_state[1];
+/**
+ * Allocates and initializes a safe-prime sieve for the integers
+ * <i>start + i * step</i>. The bound on the sieving primes is chosen
+ * based on the bit length of the start and is much larger than for
+ * gmpmee_sieve_init, but no safe prime is ever removed by the
+ * sieve. The caller is responsible for choosing the start and step
+ * such that both <i>n</i> and <i>(n-1)/2</i> are odd, e.g., start
+ * congruent to 3 modulo 4 and step 4.
+ *
+ * @param sieve Sieve to be initialized.
+ * @param start First integer of the progression. This must be
+ * positive.
+ * @param step Difference between consecutive integers. This must be
+ * positive.
+ */
+void
+gmpmee_sieve_safe_init(gmpmee_sieve sieve, mpz_t start, mpz_t step);
 
 /**
- * Initialize Miller-Rabin state to be used for safe-primality
- * testing using the given integer.
- *
- * @param state State for testing safe-primality.
- * @param n Integer to test.
+ * Equivalent to gmpmee_sieve_safe_init, except that the step is
+ * given as an unsigned long.
+ *
+ * @param sieve Sieve to be initialized.
+ * @param start First integer of the progression. This must be
+ * positive.
+ * @param step Difference between consecutive integers. This must be
+ * positive.
  */
 void
-gmpmee_millerrabin_safe_init(gmpmee_millerrabin_safe_state state, mpz_t n);
+gmpmee_sieve_safe_init_ui(gmpmee_sieve sieve, mpz_t start,
+			  unsigned long int step);
 
 /**
- * Sets the state to the next candidate integer larger than the most
- * recently tested candidate that passes the trial divisions.
+ * Sets rop to the next integer in the progression that is not
+ * divisible by any of the sieving primes.
  *
- * @param state State for testing safe-primality.
+ * @param rop Destination of result.
+ * @param sieve Sieve.
  */
 void
-gmpmee_millerrabin_safe_next_cand(gmpmee_millerrabin_safe_state state);
+gmpmee_sieve_next(mpz_t rop, gmpmee_sieve sieve);
 
 /**
- * Free memory allocated in the states.
+ * Frees the memory allocated by the sieve.
  *
- * @param state State for testing safe-primality.
+ * @param sieve Sieve to be deallocated.
  */
 void
-gmpmee_millerrabin_safe_clear(gmpmee_millerrabin_safe_state state);
+gmpmee_sieve_clear(gmpmee_sieve sieve);
 
 /**
- * Performs trial divisions and returns 0 or 1 depending on if the
- * integer is definitely a not a safe prime, or if it could
- * potentially be a safe prime. Assumes that n is at least 8.
- *
- * @param n Integer to test.
+ * Smallest bound on the primes used for trial division.
  */
+#define GMPMEE_TRIAL_MIN_BOUND 1024
 
-int
-gmpmee_millerrabin_safe_trial(mpz_t n);
+/**
+ * Largest bound on the primes used for trial division.
+ */
+#define GMPMEE_TRIAL_MAX_BOUND 1048576
 
 /**
- * Executes one round of the Miller-Rabin test and returns 0 or 1
- * depending on if the tested integer is deemed to not be a safe
- * prime, or a safe prime. Assumes that the tested integer is at least
- * 8.
- *
- * @param state State for testing safe-primality.
- * @param nbase Base element used for testing safe-primality. This
- * must be an integer in [2,n-1], where n is the integer to be tested.
- * @param mbase Base element used for testing safe-primality.  This
- * must be an integer in [2,m-1], where n=2m+1.
+ * Table of the odd primes up to GMPMEE_TRIAL_MAX_BOUND used for trial
+ * division. The primes are partitioned into groups of consecutive
+ * primes whose product fits in an unsigned long, so that a single
+ * remainder modulo the product of a group determines divisibility by
+ * every prime of the group. Divisibility of a remainder r by a prime
+ * p is decided without division as r * inverse <= limit, where the
+ * product is computed modulo the word size.
  */
-int
-gmpmee_millerrabin_safe_once(gmpmee_millerrabin_safe_state state,
-			     mpz_t nbase, mpz_t mbase);
+typedef struct
+{
+  size_t primes_len;            /**< Number of primes. */
+  unsigned long int *primes;    /**< Odd primes in increasing order. */
+  unsigned long int *inverses;  /**< Inverse of each prime modulo the
+				   word size. */
+  unsigned long int *limits;    /**< Largest word divided by each
+				   prime. */
+  size_t len;                   /**< Number of groups. */
+  unsigned long int *products;  /**< Product of the primes of each
+				   group. */
+  size_t *starts;               /**< Index of the first prime of each
+				   group, followed by primes_len. */
+} gmpmee_trial_table_struct;
 
 /**
- * Executes a safe primality test for the integer used to initialize
- * the given testing state, using randomness from the given GMP's
- * random source.
+ * Returns 1 or 0 depending on if the prime with the given index in
+ * the trial division table divides the word or not.
+ */
+#define GMPMEE_TRIAL_DIVIDES(table, i, r) \
+  ((r) * (table)->inverses[i] <= (table)->limits[i])
+
+/**
+ * Returns the table used for trial division. The table is computed
+ * on the first call and is shared by all threads.
  *
+ * @return Table used for trial division.
+ */
+const gmpmee_trial_table_struct *
+gmpmee_trial_table(void);
+
+/**
+ * Returns the number of groups of the trial division table to use
+ * for integers of the given bit length. A group is worth using if
+ * the probability that one of its primes divides a candidate times
+ * the cost of an exponentiation exceeds the cost of a remainder,
+ * which gives a bound on the primes that grows quadratically with
+ * the bit length, and twice as large in safe mode, where each prime
+ * removes twice as many candidates.
+ *
+ * @param bitlen Bit length of candidates.
+ * @param safe Determines if candidates are tested for safe
+ * primality.
+ * @return Number of groups.
+ */
+size_t
+gmpmee_trial_groups(size_t bitlen, int safe);
+
+/**
+ * Returns 0 or 1 depending on if a prime of the given group of the
+ * trial division table divides the integer with the given remainder
+ * modulo the product of the group, or in safe mode the integer or
+ * the integer minus one divided by two.
+ *
+ * @param table Trial division table.
+ * @param group Index of group.
+ * @param r Remainder modulo the product of the group.
+ * @param safe Determines if (n-1)/2 is tested as well.
+ * @return 0 if a factor was found and 1 otherwise.
+ */
+int
+gmpmee_trial_group(const gmpmee_trial_table_struct *table, size_t group,
+		   unsigned long int r, int safe);
+
+/**
+ * Smallest bit length of integers for which trial division computes
+ * gcds with products of many groups instead of one remainder of the
+ * integer for each group. This is not done in safe mode, where most
+ * candidates are removed by the leading groups and the gcds would be
+ * computed with integers of twice the size.
+ */
+#define GMPMEE_TRIAL_GCD_MIN_BITLEN 12288
+
+/**
+ * Number of leading groups of the trial division table that are
+ * always tested one by one, since they remove most candidates.
+ */
+#define GMPMEE_TRIAL_GCD_HEAD 64
+
+/**
+ * Products of consecutive ranges of groups of the trial division
+ * table following the first GMPMEE_TRIAL_GCD_HEAD groups. The ith
+ * product is the product of the groups with indices in
+ * [ends[i-1], ends[i]), where ends[-1] is GMPMEE_TRIAL_GCD_HEAD and
+ * the ends double from one range to the next until all groups are
+ * included.
+ */
+typedef struct
+{
+  size_t len;       /**< Number of products. */
+  size_t *ends;     /**< End of the range of groups of each product. */
+  mpz_t *products;  /**< Products of ranges of groups. */
+} gmpmee_trial_primorials_struct;
+
+/**
+ * Returns the products used for trial division of large integers.
+ * The products are computed on the first call and are shared by all
+ * threads.
+ *
+ * @return Products of groups.
+ */
+const gmpmee_trial_primorials_struct *
+gmpmee_trial_primorials(void);
+
+/**
+ * Performs trial division of an odd integer larger than every prime
+ * of the trial division table by the primes of at least the given
+ * number of groups. The first GMPMEE_TRIAL_GCD_HEAD groups are tested
+ * one by one. Then the gcd of the integer and each product of
+ * gmpmee_trial_primorials is computed in turn, until the products
+ * cover the given number of groups. A gcd costs about as many word
+ * operations as the remainders modulo the groups of the product, but
+ * GMP computes it with subquadratic division for large integers.
+ *
+ * @param n Odd integer to test.
+ * @param groups Number of groups.
+ * @return 0 if a factor was found and 1 otherwise.
+ */
+int
+gmpmee_trial_gcd(mpz_t n, size_t groups);
+
+/**
+ * Performs trial division of an odd integer by the primes of the
+ * table smaller than the integer, where the number of groups of the
+ * table used is given by gmpmee_trial_groups. In safe mode, the
+ * integer <i>m = (n-1)/2</i> is also tested using the same
+ * remainders, since a prime <i>p</i> divides <i>m</i> if and only if
+ * <i>n</i> is congruent to one modulo <i>p</i>, and then only primes
+ * smaller than <i>m</i> are used. Outside safe mode, integers of at
+ * least GMPMEE_TRIAL_GCD_MIN_BITLEN bits are tested using
+ * gmpmee_trial_gcd.
+ *
+ * @param n Odd integer to test.
+ * @param safe Determines if <i>(n-1)/2</i> is tested as well.
+ * @return 0 if a factor was found and 1 otherwise.
+ */
+int
+gmpmee_trial(mpz_t n, int safe);
+
+
+/* #################### Multi-lane Exponentiation #################### */
+
+#if defined(__x86_64__) && defined(__GNUC__) && GMP_NUMB_BITS == 64 \
+  && (defined(__clang__) ? __clang_major__ >= 7 : __GNUC__ >= 6)
+/**
+ * Defined if the library is compiled with the multi-lane kernels,
+ * which are only used if the processor supports them.
+ */
+#define GMPMEE_HAVE_LANES 1
+#endif
+
+/**
+ * Number of lanes of the AVX2 kernel.
+ */
+#define GMPMEE_LANES_AVX2 4
+
+/**
+ * Number of lanes of the AVX-512 IFMA kernel.
+ */
+#define GMPMEE_LANES_IFMA 8
+
+/**
+ * Largest bit length of moduli handled by the multi-lane
+ * kernels. Larger moduli are handled by mpz_powm.
+ */
+#define GMPMEE_LANES_MAX_BITLEN 16384
+
+/**
+ * Returns the number of lanes of the fastest multi-lane kernel
+ * supported by the processor, i.e., GMPMEE_LANES_IFMA,
+ * GMPMEE_LANES_AVX2, or zero if no kernel is supported. A processor
+ * that supports the IFMA kernel also supports the AVX2 kernel.
+ */
+unsigned int
+gmpmee_lanes(void);
+
+/**
+ * Smallest bit length of moduli for which the IFMA kernel is
+ * selected instead of GMP.
+ */
+#define GMPMEE_LANES_IFMA_MIN_BITLEN 320
+
+/**
+ * Smallest bit length of moduli for which the AVX2 kernel is
+ * selected instead of GMP.
+ */
+#define GMPMEE_LANES_AVX2_MIN_BITLEN 512
+
+/**
+ * Largest bit length of moduli for which the AVX2 kernel is selected
+ * instead of GMP.
+ */
+#define GMPMEE_LANES_AVX2_MAX_BITLEN 3072
+
+/**
+ * Returns the number of lanes of the multi-lane kernel that should
+ * be used for moduli of the given bit length, or zero if GMP is
+ * faster or no kernel is supported by the processor.
+ *
+ * @param bitlen Bit length of moduli.
+ */
+unsigned int
+gmpmee_lanes_select(size_t bitlen);
+
+/**
+ * Smallest number of operations with a common modulus for which the
+ * IFMA kernel is used. Unused lanes are wasted work, so a partial
+ * group must be large enough to beat GMP.
+ */
+#define GMPMEE_LANES_IFMA_MIN_BATCH 3
+
+/**
+ * Smallest number of operations with a common modulus for which the
+ * AVX2 kernel is used.
+ */
+#define GMPMEE_LANES_AVX2_MIN_BATCH 4
+
+/**
+ * Returns the number of lanes of the multi-lane kernel that should
+ * be used for len operations with a common modulus of the given bit
+ * length, or zero if GMP is faster. This is gmpmee_lanes_select
+ * restricted to batches that fill enough of the lanes.
+ *
+ * @param bitlen Bit length of the modulus.
+ * @param len Number of operations.
+ */
+unsigned int
+gmpmee_lanes_select_batch(size_t bitlen, size_t len);
+
+/**
+ * Computes independent modular exponentiations
+ * <i>rops[i]</i>=<i>bases[i]</i>^<i>exps[i]</i> mod
+ * <i>moduli[i]</i>. Groups of the given number of exponentiations
+ * are computed simultaneously in Montgomery representation by the
+ * kernel with this number of lanes. Each lane has its own modulus,
+ * but all moduli of a group are processed as if they had the bit
+ * length of the longest of them, so they should be of similar
+ * size. If the number of lanes does not correspond to a kernel, then
+ * mpz_powm is used. The result is identical to that of mpz_powm
+ * regardless of the kernel.
+ *
+ * <p>
+ *
+ * The kernel must be supported by the processor, see gmpmee_lanes.
+ *
+ * @param rops Destinations of results. These must not coincide with
+ * the moduli.
+ * @param bases Bases.
+ * @param exps Non-negative exponents.
+ * @param moduli Odd moduli greater than one.
+ * @param len Number of exponentiations.
+ * @param lanes Number of lanes of the kernel.
+ */
+void
+gmpmee_lanes_powm(mpz_t *rops, mpz_t *bases, mpz_t *exps, mpz_t *moduli,
+		  size_t len, unsigned int lanes);
+
+/**
+ * Computes <i>rops[i]</i> = <i>bases[i]</i>^<i>exps[i]</i> mod
+ * <i>modulus</i> for all 0 <= <i>i</i> < <i>len</i>. If the modulus is
+ * odd and gmpmee_lanes_select_batch selects a kernel, then the
+ * exponentiations are computed in groups by the multi-lane kernel,
+ * which shares the Montgomery constants of the modulus between all
+ * lanes. Otherwise, and for a remainder too small to fill enough
+ * lanes, mpz_powm is used. The result is identical to that of
+ * mpz_powm.
+ *
+ * @param rops Destinations of results. These must not coincide with
+ * the modulus.
+ * @param bases Bases.
+ * @param exps Non-negative exponents.
+ * @param len Number of exponentiations.
+ * @param modulus Modulus.
+ */
+void
+gmpmee_array_powm(mpz_t *rops, mpz_t *bases, mpz_t *exps, size_t len,
+		  mpz_t modulus);
+
+/**
+ * Multi-lane Montgomery multiplication kernel. Integers are
+ * represented by <i>n</i> digits of <i>bits</i> bits in each lane,
+ * and digit <i>j</i> of lane <i>l</i> is stored at index
+ * <i>j</i>*lanes+<i>l</i>, so digit <i>j</i> of all lanes is
+ * processed by a single instruction. The kernel computes the "almost
+ * Montgomery" product <i>ab</i>/<i>R</i> mod <i>m</i> in each lane,
+ * where <i>R</i>=2^(<i>n</i>*<i>bits</i>)>4<i>m</i>. If <i>a</i> and
+ * <i>b</i> are smaller than 2<i>m</i>, then so is the result, so no
+ * conditional subtractions are needed. Inputs and outputs are
+ * normalized, i.e., every digit is smaller than
+ * 2^<i>bits</i>. <i>k0</i> holds -1/<i>m</i> mod 2^<i>bits</i> of
+ * each lane, the temporary space <i>t</i> must hold 2<i>n</i>+1
+ * digits in each lane, and the output may coincide with the inputs.
+ */
+typedef void (*gmpmee_lanes_mul_func)(uint64_t *r, const uint64_t *a,
+				      const uint64_t *b, const uint64_t *m,
+				      const uint64_t *k0, uint64_t *t,
+				      size_t n, unsigned int bits);
+
+/**
+ * Alignment in bytes of multi-lane integers allocated by
+ * gmpmee_lanes_alloc. The kernels load a cache line of digits at a
+ * time, and loads that straddle two cache lines are about half as
+ * fast.
+ */
+#define GMPMEE_LANES_ALIGN 64
+
+/**
+ * Allocates space for the given number of digits aligned to
+ * GMPMEE_LANES_ALIGN bytes.
+ *
+ * @param len Number of digits.
+ * @return Allocated space, or NULL if the space can not be allocated.
+ */
+uint64_t *
+gmpmee_lanes_alloc(size_t len);
+
+/**
+ * Frees space allocated by gmpmee_lanes_alloc.
+ *
+ * @param ptr Space allocated by gmpmee_lanes_alloc, or NULL.
+ */
+void
+gmpmee_lanes_free(uint64_t *ptr);
+
+#ifdef GMPMEE_HAVE_LANES
+/**
+ * AVX-512 IFMA kernel with eight lanes of 52-bit digits, see
+ * gmpmee_lanes_mul_func.
+ */
+void
+gmpmee_lanes_mul_ifma(uint64_t *r, const uint64_t *a, const uint64_t *b,
+		      const uint64_t *m, const uint64_t *k0, uint64_t *t,
+		      size_t n, unsigned int bits);
+
+/**
+ * AVX2 kernel with four lanes of digits of at most 28 bits, see
+ * gmpmee_lanes_mul_func.
+ */
+void
+gmpmee_lanes_mul_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b,
+		      const uint64_t *m, const uint64_t *k0, uint64_t *t,
+		      size_t n, unsigned int bits);
+#endif
+
+/**
+ * Writes the <i>n</i> digits of <i>bits</i> bits of a non-negative
+ * integer to the given lane of a multi-lane integer. The integer
+ * must fit in the digits.
+ *
+ * @param d Digits of a multi-lane integer.
+ * @param n Number of digits in each lane.
+ * @param lanes Number of lanes.
+ * @param lane Lane.
+ * @param bits Number of bits of each digit.
+ * @param op Integer.
+ */
+void
+gmpmee_lanes_to_digits(uint64_t *d, size_t n, unsigned int lanes,
+		       unsigned int lane, unsigned int bits, mpz_t op);
+
+/**
+ * Reads the integer represented by the <i>n</i> normalized digits of
+ * the given lane of a multi-lane integer.
+ *
+ * @param rop Destination.
+ * @param d Digits of a multi-lane integer.
+ * @param n Number of digits in each lane.
+ * @param lanes Number of lanes.
+ * @param lane Lane.
+ * @param bits Number of bits of each digit.
+ */
+void
+gmpmee_lanes_from_digits(mpz_t rop, const uint64_t *d, size_t n,
+			 unsigned int lanes, unsigned int lane,
+			 unsigned int bits);
+
+/**
+ * Context for multi-lane Montgomery multiplication with one odd
+ * modulus in each lane. Elements are multi-lane integers of
+ * <i>size</i>=<i>n</i>*<i>lanes</i> digits holding
+ * <i>aR</i> mod <i>m</i> in each lane, but only reduced modulo
+ * 2<i>m</i>, see gmpmee_lanes_mul_func. Elements should be allocated
+ * by gmpmee_lanes_alloc.
+ */
+typedef struct
+{
+  unsigned int lanes;         /**< Number of lanes of the kernel. */
+  unsigned int bits;          /**< Number of bits of each digit. */
+  size_t n;                   /**< Number of digits in each lane. */
+  size_t size;                /**< Number of digits of an element. */
+  gmpmee_lanes_mul_func mul;  /**< Kernel. */
+  uint64_t k0[GMPMEE_LANES_IFMA]; /**< -1/m mod 2^bits of each lane. */
+  uint64_t *m;                /**< Moduli. */
+  uint64_t *r2;               /**< R^2 mod m in each lane. */
+  uint64_t *unit;             /**< One in each lane, i.e., not in
+				 Montgomery representation. */
+  uint64_t *xp;               /**< Temporary element. */
+  uint64_t *tp;               /**< Temporary space of the kernel. */
+  mpz_t moduli[GMPMEE_LANES_IFMA]; /**< Modulus of each lane. */
+  mpz_t tmp;                  /**< Temporary integer. */
+} gmpmee_lanes_mont_struct;
+
+/**
+ * Multi-lane Montgomery multiplication context.
+ */
+typedef gmpmee_lanes_mont_struct gmpmee_lanes_mont[1]; /* Magic references. */
+
+/**
+ * Initializes a context for the kernel with the given number of
+ * lanes, which must be supported by the processor, see
+ * gmpmee_lanes. Lane <i>l</i> uses the modulus <i>moduli[l]</i>
+ * and lanes beyond the given moduli use the first modulus, so a
+ * single modulus may be used in all lanes by setting <i>len</i> to
+ * one. All moduli are processed as if they had the bit length of
+ * the longest of them.
+ *
+ * @param mont Context.
+ * @param moduli Odd moduli greater than one of at most
+ * GMPMEE_LANES_MAX_BITLEN bits.
+ * @param len Number of moduli, at least one and at most the number of
+ * lanes.
+ * @param lanes Number of lanes of the kernel, i.e., GMPMEE_LANES_IFMA
+ * or GMPMEE_LANES_AVX2.
+ * @return 1 on success and 0 if memory can not be allocated, in which
+ * case the context is not initialized.
+ */
+int
+gmpmee_lanes_mont_init(gmpmee_lanes_mont mont, mpz_t *moduli, size_t len,
+		       unsigned int lanes);
+
+/**
+ * Frees the memory allocated by the context.
+ *
+ * @param mont Context.
+ */
+void
+gmpmee_lanes_mont_clear(gmpmee_lanes_mont mont);
+
+/**
+ * Converts integers to Montgomery representation, where lane
+ * <i>l</i> of the destination represents <i>ops[l]</i> modulo the
+ * modulus of the lane. Lanes beyond the given integers represent
+ * the first integer.
+ *
+ * @param mont Context.
+ * @param rp Destination element.
+ * @param ops Integers.
+ * @param len Number of integers, at least one and at most the number
+ * of lanes.
+ */
+void
+gmpmee_lanes_mont_to(gmpmee_lanes_mont mont, uint64_t *rp, mpz_t *ops,
+		     size_t len);
+
+/**
+ * Converts the first lanes of an element in Montgomery
+ * representation to integers in [0,<i>m</i>-1], where <i>m</i> is
+ * the modulus of each lane.
+ *
+ * @param mont Context.
+ * @param rops Destinations.
+ * @param ap Element.
+ * @param len Number of lanes to convert.
+ */
+void
+gmpmee_lanes_mont_from(gmpmee_lanes_mont mont, mpz_t *rops,
+		       const uint64_t *ap, size_t len);
+
+/**
+ * Multi-lane Montgomery multiplication. The destination may coincide
+ * with the inputs.
+ *
+ * @param mont Context.
+ * @param rp Destination.
+ * @param ap First factor.
+ * @param bp Second factor.
+ */
+void
+gmpmee_lanes_mont_mul(gmpmee_lanes_mont mont, uint64_t *rp,
+		      const uint64_t *ap, const uint64_t *bp);
+
+/**
+ * Multi-lane Montgomery squaring. The destination may coincide with
+ * the input.
+ *
+ * @param mont Context.
+ * @param rp Destination.
+ * @param ap Input.
+ */
+void
+gmpmee_lanes_mont_sqr(gmpmee_lanes_mont mont, uint64_t *rp,
+		      const uint64_t *ap);
+
+/**
+ * Computes <i>rops[l]</i>=<i>bases[l]</i>^<i>exps[l]</i> mod
+ * <i>m</i> simultaneously in the first lanes, where <i>m</i> is the
+ * modulus of each lane.
+ *
+ * @param mont Context.
+ * @param rops Destinations of results.
+ * @param bases Bases.
+ * @param exps Non-negative exponents.
+ * @param len Number of exponentiations, at least one and at most the
+ * number of lanes.
+ * @return 1 on success and 0 if memory can not be allocated, in which
+ * case the destinations are not modified.
+ */
+int
+gmpmee_lanes_mont_powm(gmpmee_lanes_mont mont, mpz_t *rops, mpz_t *bases,
+		       mpz_t *exps, size_t len);
+
+
+/* #################### Primality Testing #################### */
+
+/**
+ * Stores state inbetween individual invokations of the Miller-Rabin
+ * test and keeps allocated space.
+ */
+typedef struct
+{
+  mpz_t n;             /**< integer to be tested */
+  mpz_t n_minus_1;     /**< n minus one */
+  mpz_t q;             /**< q is defined by n=q*2^k+1 */
+  unsigned long int k; /**< k is defined by n=q*2^k+1 */
+  mpz_t y;             /**< y is temporary space */
+  gmpmee_mont mont;    /**< Montgomery context modulo n */
+} gmpmee_millerrabin_state_struct;
+
+/**
+ * Miller-Rabin state.
+ */
+typedef gmpmee_millerrabin_state_struct gmpmee_millerrabin_state[1]; /* Magic references. */
+
+/**
+ * Pointer to a Miller-Rabin state, e.g., to form arrays of states.
+ */
+typedef gmpmee_millerrabin_state_struct *gmpmee_millerrabin_state_ptr;
+
+
+/**
+ * Allocate and initialize Miller-Rabin state using the given integer.
+ *
+ * @param state State for testing.
+ * @param n Integer to test.
+ */
+void
+gmpmee_millerrabin_init(gmpmee_millerrabin_state state, mpz_t n);
+
+/**
+ * Updates the values of an initialized Miller-Rabin state that are
+ * derived from the integer n of the state, i.e., n-1, q and k such
+ * that n = q*2^k+1, and the reduction context. This must be called
+ * when n is replaced.
+ *
+ * @param state State for testing.
+ */
+void
+gmpmee_millerrabin_update(gmpmee_millerrabin_state_ptr state);
+
+/**
+ * Updates the state to correspond to the next larger candidate
+ * integer that passes the trial divisions.
+ *
+ * @param state State for testing primality.
+ */
+void
+gmpmee_millerrabin_next_cand(gmpmee_millerrabin_state state);
+
+/**
+ * Updates the state to correspond to the next candidate integer
+ * output by the sieve. This is equivalent to
+ * gmpmee_millerrabin_next_cand, except that the small factors are
+ * removed by sieving instead of trial division, provided that the
+ * sieve is initialized with a start point that is odd and larger
+ * than the integer of the state and with step two.
+ *
+ * @param state State for testing primality.
+ * @param sieve Sieve of candidates.
+ */
+void
+gmpmee_millerrabin_next_cand_sieve(gmpmee_millerrabin_state state,
+				   gmpmee_sieve sieve);
+
+/**
+ * Free memory resources allocated for testing.
+ *
+ * @param state State for testing.
+ */
+void
+gmpmee_millerrabin_clear(gmpmee_millerrabin_state state);
+
+/**
+ * Performs trial divisions and returns 0 or 1 depending on if a small
+ * factor of the integer has been found or not. Assumes that the input
+ * is greater than three.
+ *
+ * @param n Integer to test.
+ */
+int
+gmpmee_millerrabin_trial(mpz_t n);
+
+/**
+ * Executes one round of the Miller-Rabin test and returns 0 or 1
+ * depending on if the tested integer is deemed to be composite or
+ * not. Odd integers that fit in an unsigned long are tested by
+ * gmpmee_millerrabin_once_ui, in which case the field y of the state
+ * is not written and its value is undefined after the call.
+ *
+ * @param state State for testing.
+
+ * @param base Base element used for testing. This must be an integer
+ * in [2,n-2].
+ */
+int
+gmpmee_millerrabin_once(gmpmee_millerrabin_state state, mpz_t base);
+
+/**
+ * Executes one round of the Miller-Rabin test for an odd integer
+ * greater than three that fits in an unsigned long using native
+ * Montgomery arithmetic, and returns 0 or 1 depending on if the
+ * integer is deemed to be composite or not. If the compiler provides
+ * 128-bit integers and an unsigned long has 64 bits, then the test is
+ * computed without GMP.
+ *
+ * @param n Odd integer greater than three to test.
+ * @param base Base, which is reduced modulo n.
+ */
+int
+gmpmee_millerrabin_once_ui(unsigned long int n, unsigned long int base);
+
+/**
+ * Returns 1 or 0 depending on if the integer is a prime or not. This
+ * is exact, since a fixed set of bases reveals every composite
+ * smaller than 2<sup>64</sup> as composite, and no randomness is
+ * used.
+ *
+ * @param n Integer to test.
+ */
+int
+gmpmee_millerrabin_ui(unsigned long int n);
+
+/**
+ * Completes one round of the Miller-Rabin test, given that the
+ * temporary space y of the state holds <i>base<sup>q</sup></i> mod
+ * <i>n</i>, and returns 0 or 1 depending on if the tested integer is
+ * deemed to be composite or not. This allows the exponentiation to
+ * be computed elsewhere. Assumes that the tested integer is greater
+ * than three.
+ *
+ * @param state State for testing.
+ */
+int
+gmpmee_millerrabin_once_finish(gmpmee_millerrabin_state state);
+
+/**
+ * Executes one round of the Miller-Rabin test for each state with
+ * the corresponding base, and stores 0 or 1 in the corresponding
+ * position of the results as gmpmee_millerrabin_once does. The
+ * exponentiations of states with odd integers greater than three are
+ * computed by gmpmee_lanes_powm with the given number of lanes. The
+ * same state may occur several times.
+ *
+ * @param results Destination of results.
+ * @param states States for testing.
+ * @param bases Bases, each in [2,n-2] for the corresponding n.
+ * @param len Number of states.
+ * @param lanes Number of lanes of the kernel.
+ */
+void
+gmpmee_millerrabin_once_lanes(int *results,
+			      gmpmee_millerrabin_state_ptr *states,
+			      mpz_t *bases, size_t len, unsigned int lanes);
+
+/**
+ * Executes the Miller-Rabin test using randomness from one of GMP's
+ * random sources. Assumes that the tested integer is greater than
+ * three.
+ *
+ * @param rstate Source of randomness.
+ * @param state State for testing.
+ * @param reps Number of repetitions.
+ */
+int
+gmpmee_millerrabin_reps_rs(gmp_randstate_t rstate,
+			   gmpmee_millerrabin_state state,
+			   int reps);
+
+/**
+ * Executes the strong Lucas probable prime test with parameters
+ * chosen using Selfridge's method A, i.e., P = 1 and Q = (1 - D)/4
+ * for the first D in 5, -7, 9, -11, ... with Jacobi symbol -1, and
+ * returns 0 or 1 depending on if the tested integer is deemed to be
+ * composite or not. Assumes that the tested integer is odd and
+ * greater than three.
+ *
+ * <p>
+ *
+ * No composite is known to pass both this test and the Miller-Rabin
+ * test with base two.
+ *
+ * @param state State for testing.
+ */
+int
+gmpmee_millerrabin_lucas(gmpmee_millerrabin_state state);
+
+/**
+ * Executes the Baillie-PSW test, i.e., a round of the Miller-Rabin
+ * test with base two followed by a strong Lucas test, and then
+ * <code>reps</code> repetitions of the Miller-Rabin test using
+ * randomness from one of GMP's random sources. Returns 0 or 1
+ * depending on if the tested integer is deemed to be composite or
+ * not.
+ *
+ * <p>
+ *
+ * The Baillie-PSW test has no known counterexamples and is exact
+ * below 2^64, so a small <code>reps</code> suffices in most
+ * applications. The additional repetitions bound the error
+ * probability by 4^(-reps) regardless of the input.
+ *
+ * @param rstate Source of randomness.
+ * @param state State for testing.
+ * @param reps Number of additional repetitions.
+ */
+int
+gmpmee_millerrabin_bpsw_rs(gmp_randstate_t rstate,
+			   gmpmee_millerrabin_state state,
+			   int reps);
+
+/**
+ * Returns the number of rounds of the Miller-Rabin test with random
+ * bases needed to bound the probability that a composite integer of
+ * the given bit length is deemed to be prime by 2^(-error).
+ *
+ * <p>
+ *
+ * For an arbitrary integer each round lets a composite pass with
+ * probability at most 1/4. If the integer is a random odd integer,
+ * e.g., a candidate in a search from a random starting point, then
+ * the much stronger bounds of Damgard, Landrock, and Pomerance are
+ * used instead whenever they apply, e.g., three rounds suffice for
+ * an error of 2^(-80) for 1024 bits.
+ *
+ * @param bitlen Bit length of the tested integer.
+ * @param error Negated base two logarithm of the error target.
+ * @param random Indicates if the tested integer is a random odd
+ * integer.
+ * @return Number of rounds, which is at least one.
+ */
+int
+gmpmee_millerrabin_error_reps(unsigned long int bitlen,
+			      unsigned long int error, int random);
+
+/**
+ * Executes a number or repetitions of the Miller-Rabin test using
+ * basis derived from the given GMP random source and returns 0 or 1
+ * depending on if the tested integer is deemed to be composite or
+ * not.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * <p>
+ *
+ * Integers that fit in an unsigned long are tested exactly by
+ * gmpmee_millerrabin_ui without using the source of randomness.
+ *
+ * @param rstate State of random number generator.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+int
+gmpmee_millerrabin_rs(gmp_randstate_t rstate, mpz_t n, int reps);
+
+/**
+ * Searches for the smallest prime larger than the given
+ * integer. Primality testing is done using the Miller-Rabin test
+ * using randomness from one of GMP's random sources.
+ *
+ * @param rop Result destination.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ */
+void
+gmpmee_millerrabin_next_rs(mpz_t rop, gmp_randstate_t rstate,
+			   mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_next_rs, except that the
+ * candidates are tested by the given number of threads. The output
+ * is the smallest prime larger than the input integer regardless of
+ * the number of threads.
+ *
+ * @param rop Result destination.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_next_mt_rs(mpz_t rop, gmp_randstate_t rstate, mpz_t n,
+			      int reps, unsigned int nthreads);
+
+/**
+ * Largest number of candidates tested at a time by
+ * gmpmee_millerrabin_next_k_mt_rs.
+ */
+#define GMPMEE_NEXT_K_MAX_CHUNK 4096
+
+/**
+ * Sets rops[0],...,rops[k-1] to the k smallest primes larger than
+ * the given integer, in increasing order. The odd integers larger
+ * than n are sieved once, and the candidates that survive are
+ * tested in chunks as by gmpmee_millerrabin_array_rs, in order, until
+ * k primes are found.
+ *
+ * @param rops Destination of the primes. This must hold k
+ * initialized integers.
+ * @param k Number of primes.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ */
+void
+gmpmee_millerrabin_next_k_rs(mpz_t *rops, size_t k, gmp_randstate_t rstate,
+			     mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_next_k_rs, except that the
+ * candidates of each chunk are tested by the given number of
+ * threads.
+ *
+ * @param rops Destination of the primes. This must hold k
+ * initialized integers.
+ * @param k Number of primes.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_next_k_mt_rs(mpz_t *rops, size_t k,
+				gmp_randstate_t rstate, mpz_t n, int reps,
+				unsigned int nthreads);
+
+/**
+ * Equivalent to gmpmee_millerrabin_next_rs, except that the number
+ * of repetitions is derived from the bit length of the input
+ * integer and an error target using gmpmee_millerrabin_error_reps.
+ *
+ * @param rop Result destination.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param error Negated base two logarithm of the error target.
+ * @param random Indicates if the starting point is random.
+ */
+void
+gmpmee_millerrabin_next_error_rs(mpz_t rop, gmp_randstate_t rstate, mpz_t n,
+				 unsigned long int error, int random);
+
+/**
+ * Stores the states needed for using the Miller-Rabin test for
+ * testing for safe-primality.
+ */
+typedef struct
+{
+  /**
+   * State of the integer <i>n</i> to be tested.
+   */
+  gmpmee_millerrabin_state nstate;
+
+  /**
+   * State of the integer <i>(n-1)/2</i> to be tested.
+   */
+  gmpmee_millerrabin_state mstate;
+
+} gmpmee_millerrabin_safe_state[1];
+
+/**
+ * Initialize Miller-Rabin state to be used for safe-primality
+ * testing using the given integer.
+ *
+ * @param state State for testing safe-primality.
+ * @param n Integer to test.
+ */
+void
+gmpmee_millerrabin_safe_init(gmpmee_millerrabin_safe_state state, mpz_t n);
+
+/**
+ * Sets the state to the next candidate integer larger than the most
+ * recently tested candidate that passes the trial divisions.
+ *
+ * @param state State for testing safe-primality.
+ */
+void
+gmpmee_millerrabin_safe_next_cand(gmpmee_millerrabin_safe_state state);
+
+/**
+ * Sets the state to the next candidate integer output by the
+ * sieve. This is equivalent to gmpmee_millerrabin_safe_next_cand,
+ * except that small factors are removed by the sieve instead of
+ * trial division, provided that the sieve is a safe-prime sieve
+ * initialized with a start point that is congruent to 3 modulo 4 and
+ * larger than the integer of the state, and with step 4.
+ *
+ * @param state State for testing safe-primality.
+ * @param sieve Safe-prime sieve of candidates.
+ */
+void
+gmpmee_millerrabin_safe_next_cand_sieve(gmpmee_millerrabin_safe_state state,
+					gmpmee_sieve sieve);
+
+/**
+ * Free memory allocated in the states.
+ *
+ * @param state State for testing safe-primality.
+ */
+void
+gmpmee_millerrabin_safe_clear(gmpmee_millerrabin_safe_state state);
+
+/**
+ * Performs trial divisions and returns 0 or 1 depending on if the
+ * integer is definitely a not a safe prime, or if it could
+ * potentially be a safe prime. Assumes that n is at least 8.
+ *
+ * @param n Integer to test.
+ */
+
+int
+gmpmee_millerrabin_safe_trial(mpz_t n);
+
+/**
+ * Executes one round of the Miller-Rabin test and returns 0 or 1
+ * depending on if the tested integer is deemed to not be a safe
+ * prime, or a safe prime. Assumes that the tested integer is at least
+ * 8.
+ *
+ * @param state State for testing safe-primality.
+ * @param nbase Base element used for testing safe-primality. This
+ * must be an integer in [2,n-1], where n is the integer to be tested.
+ * @param mbase Base element used for testing safe-primality.  This
+ * must be an integer in [2,m-1], where n=2m+1.
+ */
+int
+gmpmee_millerrabin_safe_once(gmpmee_millerrabin_safe_state state,
+			     mpz_t nbase, mpz_t mbase);
+
+/**
+ * Executes a safe primality test for the integer used to initialize
+ * the given testing state, using randomness from the given GMP's
+ * random source.
+ *
+ * <p>
+ *
+ * The integer <i>m=(n-1)/2</i> is first tested with base two, and
+ * then <i>n</i> is tested using Pocklington's criterion with base
+ * two, which proves that <i>n</i> is prime if <i>m</i> is
+ * prime. Only then are <code>reps + 1</code> repetitions of the
+ * Miller-Rabin test with random bases executed for <i>m</i>.
+ *
+ * @param rstate Source of randomness.
+ * @param state State for testing safe-primality.
+ * @param reps Number of repetitions.
+ */
+int
+gmpmee_millerrabin_safe_reps_rs(gmp_randstate_t rstate,
+				gmpmee_millerrabin_safe_state state,
+				int reps);
+
+/**
+ * Completes gmpmee_millerrabin_safe_reps_rs for a state for which
+ * <i>m=(n-1)/2</i> has passed a round of the Miller-Rabin test with
+ * base two, i.e., tests <i>n</i> using Pocklington's criterion and
+ * then executes <code>reps + 1</code> repetitions for <i>m</i>.
+ *
+ * @param rstate Source of randomness.
+ * @param state State for testing safe-primality.
+ * @param reps Number of repetitions.
+ */
+int
+gmpmee_millerrabin_safe_pocklington_rs(gmp_randstate_t rstate,
+				       gmpmee_millerrabin_safe_state state,
+				       int reps);
+
+/**
+ * Safe-prime analogue of gmpmee_millerrabin_bpsw_rs. Executes the
+ * Miller-Rabin test with base two for <i>m=(n-1)/2</i>, tests
+ * <i>n</i> using Pocklington's criterion, and then completes the
+ * Baillie-PSW test of <i>m</i> followed by <code>reps</code>
+ * repetitions of the Miller-Rabin test with random bases for
+ * <i>m</i>. Assumes that <i>m</i> is odd and greater than three.
+ *
+ * @param rstate Source of randomness.
+ * @param state State for testing safe-primality.
+ * @param reps Number of additional repetitions.
+ */
+int
+gmpmee_millerrabin_safe_bpsw_rs(gmp_randstate_t rstate,
+				gmpmee_millerrabin_safe_state state,
+				int reps);
+
+/**
+ * Executes several repetitions of the of the Miller-Rabin test and
+ * returns 0 or 1 depending on if the tested integer is deemed to not
+ * be a safe prime, or a safe prime. The basis elements are derived
+ * from the given random number generator.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * <p>
+ *
+ * Integers that fit in an unsigned long are tested exactly by
+ * gmpmee_millerrabin_ui without using the source of randomness.
+ *
+ * @param rstate State of random number generator.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+int
+gmpmee_millerrabin_safe_rs(gmp_randstate_t rstate, mpz_t n, int reps);
+
+/**
+ * Uses gmpmee_millerrabin_safe_rs to find the smallest safe prime
+ * larger than the input integer.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * <p>
+ *
+ * @param rop Found safe prime.
+ * @param rstate State of random number generator.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+void
+gmpmee_millerrabin_safe_next_rs(mpz_t rop, gmp_randstate_t rstate,
+				mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_safe_next_rs, except that the
+ * candidates are tested by the given number of threads. The output
+ * is the smallest safe prime larger than the input integer
+ * regardless of the number of threads.
+ *
+ * @param rop Found safe prime.
+ * @param rstate State of random number generator.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_safe_next_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+				   mpz_t n, int reps, unsigned int nthreads);
+
+/**
+ * Equivalent to gmpmee_millerrabin_safe_next_rs, except that the
+ * number of repetitions is derived from the bit length of
+ * <i>m=(n-1)/2</i> and an error target using
+ * gmpmee_millerrabin_error_reps.
+ *
+ * @param rop Found safe prime.
+ * @param rstate State of random number generator.
+ * @param n Starting point in search.
+ * @param error Negated base two logarithm of the error target.
+ * @param random Indicates if the starting point is random.
+ */
+void
+gmpmee_millerrabin_safe_next_error_rs(mpz_t rop, gmp_randstate_t rstate,
+				      mpz_t n, unsigned long int error,
+				      int random);
+
+/**
+ * Searches for the smallest prime <i>p</i> larger than the given
+ * integer such that <i>p = kq + 1</i> for some positive integer
+ * <i>k</i>, i.e., such that the multiplicative group modulo
+ * <i>p</i> has a subgroup of order <i>q</i>. The integers
+ * <i>kq + 1</i> are sieved, so only candidates without small
+ * factors are tested. Primality testing is done using the
+ * Miller-Rabin test using randomness from one of GMP's random
+ * sources.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * @param rop Found prime.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param q Order of subgroup. This must be positive.
+ * @param reps Number of repetitions.
+ */
+void
+gmpmee_millerrabin_subgroup_next_rs(mpz_t rop, gmp_randstate_t rstate,
+				    mpz_t n, mpz_t q, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_subgroup_next_rs, except that the
+ * candidates are tested by the given number of threads. The output
+ * is the same regardless of the number of threads.
+ *
+ * @param rop Found prime.
+ * @param rstate Source of randomness.
+ * @param n Starting point in search.
+ * @param q Order of subgroup. This must be positive.
+ * @param reps Number of repetitions.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_subgroup_next_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+				       mpz_t n, mpz_t q, int reps,
+				       unsigned int nthreads);
+
+/**
+ * Sets rop to a random prime of the given bit length. A random odd
+ * integer of the given bit length is chosen as a starting point and
+ * the integers following it are sieved and tested as in
+ * gmpmee_millerrabin_search_rs. To limit the bias towards primes
+ * that follow long gaps between primes, a fresh starting point is
+ * chosen if no prime of the given bit length is found among the
+ * first bits / 8 + 16 candidates that survive the sieve.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * @param rop Found prime.
+ * @param rstate Source of randomness.
+ * @param bits Bit length of the prime. This must be at least two.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+void
+gmpmee_random_prime_rs(mpz_t rop, gmp_randstate_t rstate,
+		       unsigned long int bits, int reps);
+
+/**
+ * Equivalent to gmpmee_random_prime_rs, except that the candidates
+ * following each starting point are tested by the given number of
+ * threads.
+ *
+ * @param rop Found prime.
+ * @param rstate Source of randomness.
+ * @param bits Bit length of the prime. This must be at least two.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_random_prime_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+			  unsigned long int bits, int reps,
+			  unsigned int nthreads);
+
+/**
+ * Sets rop to a random safe prime of the given bit length. This is
+ * equivalent to gmpmee_random_prime_rs, except that the starting
+ * points are congruent to 3 modulo 4, the candidates are sieved and
+ * tested as safe primes, and a fresh starting point is chosen if no
+ * safe prime of the given bit length is found among the first
+ * 2 * bits + 16 candidates that survive the sieve.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * @param rop Found safe prime.
+ * @param rstate Source of randomness.
+ * @param bits Bit length of the safe prime. This must be at least
+ * three.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+void
+gmpmee_random_safe_prime_rs(mpz_t rop, gmp_randstate_t rstate,
+			    unsigned long int bits, int reps);
+
+/**
+ * Equivalent to gmpmee_random_safe_prime_rs, except that the
+ * candidates following each starting point are tested by the given
+ * number of threads.
+ *
+ * @param rop Found safe prime.
+ * @param rstate Source of randomness.
+ * @param bits Bit length of the safe prime. This must be at least
+ * three.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_random_safe_prime_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+			       unsigned long int bits, int reps,
+			       unsigned int nthreads);
+
+/**
+ * Number of bits of the seeds used to derive independent sources of
+ * randomness for threads from a given source.
+ */
+#define GMPMEE_SEED_BITS 128
+
+/**
+ * Smallest bit length of candidates for which a search is
+ * multi-threaded. Smaller candidates are always tested by a single
+ * thread.
+ */
+#define GMPMEE_SEARCH_MT_MIN_BITLEN 512
+
+/**
+ * Tests each integer in an array for primality as
+ * gmpmee_millerrabin_rs does and stores 0 or 1 in the corresponding
+ * position of the results depending on if the integer is deemed to
+ * be composite or not. The integers are divided among the given
+ * number of threads, each using a source of randomness derived from
+ * the given source, provided that some integer has at least
+ * GMPMEE_SEARCH_MT_MIN_BITLEN bits. Testing of an integer stops at
+ * the first trial division or round that reveals it as composite.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * @param results Destination of results.
  * @param rstate Source of randomness.
+ * @param candidates Integers to test.
+ * @param len Number of integers.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_array_rs(int *results, gmp_randstate_t rstate,
+			    mpz_t *candidates, size_t len, int reps,
+			    unsigned int nthreads);
+
+/**
+ * Tests the candidates output by the sieve in order and sets rop to
+ * the first candidate that is deemed to be a prime, or a safe prime
+ * if the sieve is a safe-prime sieve. The candidates are tested by
+ * the given number of threads, each using a source of randomness
+ * derived from the given source, provided that the candidates have
+ * at least GMPMEE_SEARCH_MT_MIN_BITLEN bits. Each candidate is handed
+ * out by the
+ * sieve with a sequence number, and no candidate is handed out after
+ * a candidate with a smaller sequence number has passed the test, so
+ * the output does not depend on the number of threads.
+ *
+ * <p>
+ *
+ * The sieve must output odd candidates greater than three. In the
+ * case of a safe-prime sieve the candidates n must be at least 8 and
+ * such that (n-1)/2 is odd.
+ *
+ * <p>
+ *
+ * WARNING! GMP's random number generators are NOT cryptographically
+ * secure.
+ *
+ * <p>
+ *
+ * @param rop Found (safe) prime.
+ * @param rstate State of random number generator.
+ * @param sieve Sieve of candidates.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param max_cands Maximal number of candidates to test, or zero if
+ * there is no bound.
+ * @param nthreads Number of threads.
+ * @return 1 if a (safe) prime was found and 0 otherwise.
+ */
+int
+gmpmee_millerrabin_search_rs(mpz_t rop, gmp_randstate_t rstate,
+			     gmpmee_sieve sieve, int reps, size_t max_cands,
+			     unsigned int nthreads);
+
+/**
+ * Number of bytes of the seeds from which the bases of the
+ * Miller-Rabin test are derived by the functions with suffix _hs.
+ */
+#define GMPMEE_HASH_SEED_BYTES 16
+
+/**
+ * Sets base to an almost uniformly distributed integer in [2,n-2]
+ * derived deterministically from the seed, the integer, and the
+ * index of the round using SipHash-2-4 keyed by the seed. Assumes
+ * that n is greater than four.
+ *
+ * <p>
+ *
+ * The functions with suffix _hs use such bases instead of drawing
+ * them from a source of randomness. Thus, they keep no mutable
+ * state, can be called from any number of threads without
+ * synchronization, and their results are reproducible. For a secret
+ * uniformly random seed an adversary choosing n can not predict the
+ * bases.
+ *
+ * @param base Destination of the base.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Integer to test.
+ * @param round Index of the round.
+ */
+void
+gmpmee_millerrabin_hash_base(mpz_t base, const unsigned char *seed,
+			     mpz_t n, unsigned long int round);
+
+/**
+ * Equivalent to gmpmee_millerrabin_reps_rs, except that the rounds
+ * with indices round, round + 1,..., round + reps - 1 use bases
+ * derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param state State for testing.
+ * @param round Index of the first round.
+ * @param reps Number of repetitions.
+ */
+int
+gmpmee_millerrabin_reps_hs(const unsigned char *seed,
+			   gmpmee_millerrabin_state state,
+			   unsigned long int round, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_rs, except that the bases are
+ * derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+int
+gmpmee_millerrabin_hs(const unsigned char *seed, mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_safe_pocklington_rs, except that
+ * the bases are derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
  * @param state State for testing safe-primality.
  * @param reps Number of repetitions.
  */
-int
-gmpmee_millerrabin_safe_reps_rs(gmp_randstate_t rstate,
-				gmpmee_millerrabin_safe_state state,
-				int reps);
+int
+gmpmee_millerrabin_safe_pocklington_hs(const unsigned char *seed,
+				       gmpmee_millerrabin_safe_state state,
+				       int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_safe_rs, except that the bases
+ * are derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Integer to test.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+int
+gmpmee_millerrabin_safe_hs(const unsigned char *seed, mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_array_rs, except that the bases
+ * are derived using gmpmee_millerrabin_hash_base. The results only
+ * depend on the seed and the candidates.
+ *
+ * @param results Destination of results.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param candidates Integers to test.
+ * @param len Number of integers.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_array_hs(int *results, const unsigned char *seed,
+			    mpz_t *candidates, size_t len, int reps,
+			    unsigned int nthreads);
+
+/**
+ * Implements gmpmee_millerrabin_search_rs and
+ * gmpmee_millerrabin_search_hs. If the seed is NULL, then the bases
+ * are drawn from the source of randomness, and otherwise they are
+ * derived from the seed and the source of randomness is not used.
+ *
+ * @param rop Found (safe) prime.
+ * @param rstate Source of randomness, or NULL if seed is not NULL.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes, or NULL.
+ * @param sieve Sieve of candidates.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param max_cands Maximal number of candidates to test, or zero if
+ * there is no bound.
+ * @param end Upper bound (exclusive) on the (safe) prime, or NULL if
+ * there is no bound. Candidates are only tested if they are smaller.
+ * @param tested Destination of the number of candidates tested up to
+ * and including the (safe) prime if one was found, and of all tested
+ * candidates otherwise, or NULL.
+ * @param nthreads Number of threads.
+ * @return 1 if a (safe) prime was found and 0 otherwise.
+ */
+int
+gmpmee_millerrabin_search(mpz_t rop, gmp_randstate_t rstate,
+			  const unsigned char *seed, gmpmee_sieve sieve,
+			  int reps, size_t max_cands, mpz_t end,
+			  size_t *tested, unsigned int nthreads);
+
+/**
+ * Implements gmpmee_millerrabin_array_rs and
+ * gmpmee_millerrabin_array_hs. The seed selects the bases as for
+ * gmpmee_millerrabin_search.
+ *
+ * @param results Destination of results.
+ * @param rstate Source of randomness, or NULL if seed is not NULL.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes, or NULL.
+ * @param candidates Integers to test.
+ * @param len Number of integers.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_array(int *results, gmp_randstate_t rstate,
+			 const unsigned char *seed, mpz_t *candidates,
+			 size_t len, int reps, unsigned int nthreads);
+
+/**
+ * Implements gmpmee_millerrabin_next_mt_rs and
+ * gmpmee_millerrabin_next_mt_hs. The seed selects the bases as for
+ * gmpmee_millerrabin_search.
+ *
+ * @param rop Destination of prime.
+ * @param rstate Source of randomness, or NULL if seed is not NULL.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes, or NULL.
+ * @param n Lower bound.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_next_mt(mpz_t rop, gmp_randstate_t rstate,
+			   const unsigned char *seed, mpz_t n, int reps,
+			   unsigned int nthreads);
+
+/**
+ * Implements gmpmee_millerrabin_safe_next_mt_rs and
+ * gmpmee_millerrabin_safe_next_mt_hs. The seed selects the bases as
+ * for gmpmee_millerrabin_search.
+ *
+ * @param rop Destination of safe prime.
+ * @param rstate Source of randomness, or NULL if seed is not NULL.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes, or NULL.
+ * @param n Lower bound.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_safe_next_mt(mpz_t rop, gmp_randstate_t rstate,
+				const unsigned char *seed, mpz_t n, int reps,
+				unsigned int nthreads);
+
+/**
+ * Equivalent to gmpmee_millerrabin_search_rs, except that the bases
+ * are derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param rop Found (safe) prime.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param sieve Sieve of candidates.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param max_cands Maximal number of candidates to test, or zero if
+ * there is no bound.
+ * @param nthreads Number of threads.
+ * @return 1 if a (safe) prime was found and 0 otherwise.
+ */
+int
+gmpmee_millerrabin_search_hs(mpz_t rop, const unsigned char *seed,
+			     gmpmee_sieve sieve, int reps, size_t max_cands,
+			     unsigned int nthreads);
+
+/**
+ * Equivalent to gmpmee_millerrabin_next_rs, except that the bases
+ * are derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param rop Result destination.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ */
+void
+gmpmee_millerrabin_next_hs(mpz_t rop, const unsigned char *seed, mpz_t n,
+			   int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_next_mt_rs, except that the bases
+ * are derived using gmpmee_millerrabin_hash_base.
+ *
+ * @param rop Result destination.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Starting point in search.
+ * @param reps Number of repetitions.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_next_mt_hs(mpz_t rop, const unsigned char *seed, mpz_t n,
+			      int reps, unsigned int nthreads);
 
 /**
- * Executes several repetitions of the of the Miller-Rabin test and
- * returns 0 or 1 depending on if the tested integer is deemed to not
- * be a safe prime, or a safe prime. The basis elements are derived
- * from the given random number generator.
+ * Equivalent to gmpmee_millerrabin_safe_next_rs, except that the
+ * bases are derived using gmpmee_millerrabin_hash_base.
  *
- * <p>
+ * @param rop Found safe prime.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Starting point in search.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ */
+void
+gmpmee_millerrabin_safe_next_hs(mpz_t rop, const unsigned char *seed,
+				mpz_t n, int reps);
+
+/**
+ * Equivalent to gmpmee_millerrabin_safe_next_mt_rs, except that the
+ * bases are derived using gmpmee_millerrabin_hash_base.
  *
- * WARNING! GMP's random number generators are NOT cryptographically
- * secure.
+ * @param rop Found safe prime.
+ * @param seed Seed of GMPMEE_HASH_SEED_BYTES bytes.
+ * @param n Starting point in search.
+ * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param nthreads Number of threads.
+ */
+void
+gmpmee_millerrabin_safe_next_mt_hs(mpz_t rop, const unsigned char *seed,
+				   mpz_t n, int reps, unsigned int nthreads);
+
+/**
+ * Smallest number of candidates tested between two calls of the
+ * progress callback of a resumable safe-prime search.
+ */
+#define GMPMEE_SAFE_SEARCH_MIN_CHUNK 16
+
+/**
+ * Largest number of candidates tested between two calls of the
+ * progress callback of a resumable safe-prime search.
+ */
+#define GMPMEE_SAFE_SEARCH_MAX_CHUNK 65536
+
+/**
+ * Targeted time in seconds between two calls of the progress
+ * callback of a resumable safe-prime search.
+ */
+#define GMPMEE_SAFE_SEARCH_INTERVAL 0.25
+
+/**
+ * Stores the state of a search for the smallest safe prime in a
+ * range that can be run in several parts, e.g., with bounds on the
+ * time or number of candidates of each part, and written to and
+ * read from a stream in between parts. Thus, a search can survive a
+ * restart of the process and a range can be split into subranges
+ * that are searched on different machines.
  *
  * <p>
  *
- * @param rstate State of random number generator.
- * @param n Integer to test.
- * @param reps Repetitions of the Miller-Rabin test performed.
+ * The search only tests integers congruent to 3 modulo 4, since
+ * these are the only candidates larger than 7, and the position of
+ * the search is the smallest such integer that has not been handed
+ * out by the sieve.
  */
-int
-gmpmee_millerrabin_safe_rs(gmp_randstate_t rstate, mpz_t n, int reps);
+typedef struct
+{
+  mpz_t next;                /**< Position of the search. */
+  mpz_t end;                 /**< Upper bound on the range (exclusive),
+				or zero if there is no bound. */
+  int reps;                  /**< Repetitions of the Miller-Rabin
+				test. */
+  int found;                 /**< Indicates if result is a safe
+				prime. */
+  int exhausted;             /**< Indicates that the range contains no
+				safe prime. */
+  mpz_t result;              /**< Safe prime found. */
+  unsigned long int sieved;  /**< Number of integers congruent to 3
+				modulo 4 passed by the search. */
+  unsigned long int tested;  /**< Number of candidates that passed
+				the sieve and were tested. */
+  double seconds;            /**< Total running time in seconds. */
+  double rate;               /**< Candidates tested per second in the
+				most recent part. */
+  size_t chunk;              /**< Candidates tested between two calls
+				of the progress callback. */
+  int sieve_ready;           /**< Indicates if sieve is initialized. */
+  gmpmee_sieve sieve;        /**< Sieve of candidates at the position
+				of the search. */
+} gmpmee_millerrabin_safe_search_struct;
 
 /**
- * Uses gmpmee_millerrabin_safe_rs to find the smallest safe prime
- * larger than the input integer.
+ * Resumable safe-prime search, see
+ * gmpmee_millerrabin_safe_search_struct.
+ */
+typedef gmpmee_millerrabin_safe_search_struct
+gmpmee_millerrabin_safe_search[1]; /* Magic references. */
+
+/**
+ * Callback used to report the progress of a resumable safe-prime
+ * search. The counters, running time, and rate of the search are up
+ * to date when it is called.
+ */
+typedef void
+(*gmpmee_millerrabin_safe_search_progress)
+(gmpmee_millerrabin_safe_search_struct *search, void *arg);
+
+/**
+ * Initializes a search for the smallest safe prime that is greater
+ * than or equal to start and smaller than end.
+ *
+ * @param search Search to initialize.
+ * @param start Smallest integer in the range.
+ * @param end Upper bound on the range (exclusive), or zero if there
+ * is no bound.
+ * @param reps Repetitions of the Miller-Rabin test performed as in
+ * gmpmee_millerrabin_safe_next_rs.
+ */
+void
+gmpmee_millerrabin_safe_search_init(gmpmee_millerrabin_safe_search search,
+				    mpz_t start, mpz_t end, int reps);
+
+/**
+ * Frees the resources allocated by a search.
+ *
+ * @param search Search to free.
+ */
+void
+gmpmee_millerrabin_safe_search_clear(gmpmee_millerrabin_safe_search search);
+
+/**
+ * Continues a search until a safe prime is found, the range is
+ * exhausted, or one of the bounds is reached. The bounds are only
+ * checked between the parts tested between two calls of the
+ * callback, so they may be exceeded slightly.
+ *
+ * <p>
+ *
+ * The output is the smallest safe prime in the range regardless of
+ * how the search is split into parts and the number of threads.
  *
  * <p>
  *
  * WARNING! GMP's random number generators are NOT cryptographically
  * secure.
  *
- * <p>
+ * @param search Search to continue.
+ * @param rstate Source of randomness.
+ * @param max_cands Maximal number of candidates to test, or zero if
+ * there is no bound.
+ * @param max_ms Maximal running time in milliseconds, or zero if
+ * there is no bound.
+ * @param nthreads Number of threads.
+ * @param progress Progress callback, or NULL.
+ * @param arg Argument passed to the callback.
+ * @return 1 if the search is finished, i.e., a safe prime was found
+ * or the range was exhausted, and 0 otherwise.
+ */
+int
+gmpmee_millerrabin_safe_search_run_rs(gmpmee_millerrabin_safe_search search,
+				      gmp_randstate_t rstate,
+				      unsigned long int max_cands,
+				      unsigned long int max_ms,
+				      unsigned int nthreads,
+				      gmpmee_millerrabin_safe_search_progress
+				      progress, void *arg);
+
+/**
+ * Writes the position, range, counters, and result of a search to a
+ * stream in a portable text format.
  *
- * @param rop Found safe prime.
- * @param rstate State of random number generator.
- * @param n Integer to test.
- * @param reps Repetitions of the Miller-Rabin test performed.
+ * @param stream Destination stream.
+ * @param search Search to write.
+ * @return 1 on success and 0 on error.
+ */
+int
+gmpmee_millerrabin_safe_search_fwrite(FILE *stream,
+				      gmpmee_millerrabin_safe_search search);
+
+/**
+ * Initializes a search from a stream written using
+ * gmpmee_millerrabin_safe_search_fwrite. The search is not
+ * initialized if reading fails, if the search was written with a
+ * different number of repetitions, or if the state read is
+ * inconsistent, e.g., if it is marked as found without a safe prime
+ * in the range.
+ *
+ * @param search Search to initialize.
+ * @param stream Source stream.
+ * @param reps Repetitions of the Miller-Rabin test expected.
+ * @return 1 on success and 0 on error.
+ */
+int
+gmpmee_millerrabin_safe_search_fread(gmpmee_millerrabin_safe_search search,
+				     FILE *stream, int reps);
+
+/* #################### Instrumentation #################### */
+
+/**
+ * Counters and parameters of the exponentiation and primality
+ * testing routines executed by a thread. These are only maintained
+ * if the library is configured with --enable-stats, which defines
+ * GMPMEE_STATS. Otherwise no code is executed to maintain them and
+ * every snapshot is zero.
+ */
+typedef struct
+{
+  unsigned long int sqr;   /**< Modular squarings. */
+  unsigned long int mul;   /**< Modular multiplications. */
+  unsigned long int redc;  /**< Modular reductions, i.e., divisions by
+			      the modulus and Montgomery reductions. */
+  unsigned long int powm;  /**< Exponentiations delegated to GMP. */
+  unsigned long int lanes_sqr; /**< Squarings of multi-lane kernels,
+				  each squaring all lanes. */
+  unsigned long int lanes_mul; /**< Multiplications of multi-lane
+				  kernels. */
+  unsigned long int mr_rounds; /**< Rounds of the Miller-Rabin test. */
+  unsigned long int lucas; /**< Strong Lucas tests. */
+  size_t table_bytes;      /**< Bytes of the largest table of
+			      precomputed products. */
+  size_t block_width;      /**< Block width of the last table. */
+  size_t batch_len;        /**< Number of bases of the last table. */
+  double precomp_seconds;  /**< Seconds spent on precomputation. */
+  double eval_seconds;     /**< Seconds spent on evaluation using
+			      precomputed tables. */
+} gmpmee_stats_struct;
+
+/**
+ * Counters of a thread.
+ */
+typedef gmpmee_stats_struct gmpmee_stats[1]; /* Magic references. */
+
+/**
+ * Returns 1 if the library maintains counters and 0 otherwise.
+ */
+int
+gmpmee_stats_enabled(void);
+
+/**
+ * Writes a snapshot of the counters of the calling thread to the
+ * destination.
+ *
+ * @param rop Destination of the snapshot.
  */
 void
-gmpmee_millerrabin_safe_next_rs(mpz_t rop, gmp_randstate_t rstate,
-				mpz_t n, int reps);
+gmpmee_stats_get(gmpmee_stats rop);
+
+/**
+ * Resets the counters of the calling thread.
+ */
+void
+gmpmee_stats_reset(void);
+
+/**
+ * Adds a snapshot, typically taken by another thread, to the
+ * counters of the calling thread. The multi-threaded routines use
+ * this to account for the work of their threads in the counters of
+ * the caller. The table size is the largest of the two sizes, and
+ * the table parameters are replaced if they are set in the
+ * snapshot.
+ *
+ * @param op Snapshot of counters.
+ */
+void
+gmpmee_stats_add(gmpmee_stats op);
+
+/**
+ * Writes the counters in human-readable form to the stream with
+ * one counter on each line.
+ *
+ * @param stream Destination stream.
+ * @param op Snapshot of counters.
+ */
+void
+gmpmee_stats_fprint(FILE *stream, gmpmee_stats op);
+
+/**
+ * Returns the time in seconds of a monotonic clock.
+ */
+double
+gmpmee_stats_seconds(void);
+
+#ifdef GMPMEE_STATS
+
+/**
+ * Counters of the calling thread.
+ */
+extern __thread gmpmee_stats_struct gmpmee_stats_local;
+
+/**
+ * Increments a counter of the calling thread.
+ */
+#define GMPMEE_STATS_INC(field) (gmpmee_stats_local.field++)
+
+/**
+ * Sets a counter of the calling thread.
+ */
+#define GMPMEE_STATS_SET(field, value) (gmpmee_stats_local.field = (value))
+
+/**
+ * Sets a counter of the calling thread to the maximum of its value
+ * and the given value.
+ */
+#define GMPMEE_STATS_MAX(field, value)			\
+  do							\
+    {							\
+      size_t gmpmee_stats_v = (value);			\
+      if (gmpmee_stats_v > gmpmee_stats_local.field)	\
+	{						\
+	  gmpmee_stats_local.field = gmpmee_stats_v;	\
+	}						\
+    }							\
+  while (0)
+
+/**
+ * Executes the statement and adds the time it takes to a counter of
+ * the calling thread.
+ */
+#define GMPMEE_STATS_TIME(field, statement)			\
+  do								\
+    {								\
+      double gmpmee_stats_t = gmpmee_stats_seconds();		\
+      statement;						\
+      gmpmee_stats_local.field +=				\
+	gmpmee_stats_seconds() - gmpmee_stats_t;		\
+    }								\
+  while (0)
+
+#else
+
+#define GMPMEE_STATS_INC(field) ((void)0)
+#define GMPMEE_STATS_SET(field, value) ((void)0)
+#define GMPMEE_STATS_MAX(field, value) ((void)0)
+#define GMPMEE_STATS_TIME(field, statement) statement
+
+#endif
+
+/* #################### Tracing #################### */
+
+/**
+ * Trace operation of gmpmee_spowm.
+ */
+#define GMPMEE_TRACE_SPOWM 1
+
+/**
+ * Trace operation of gmpmee_spowm_block_batch.
+ */
+#define GMPMEE_TRACE_SPOWM_BLOCK_BATCH 2
+
+/**
+ * Trace operation of gmpmee_spowm_naive.
+ */
+#define GMPMEE_TRACE_SPOWM_NAIVE 3
+
+/**
+ * Trace operation of gmpmee_spowm_precomp.
+ */
+#define GMPMEE_TRACE_SPOWM_PRECOMP 4
+
+/**
+ * Trace operation of gmpmee_spowm_table.
+ */
+#define GMPMEE_TRACE_SPOWM_TABLE 5
+
+/**
+ * Trace operation of gmpmee_fpowm_precomp.
+ */
+#define GMPMEE_TRACE_FPOWM_PRECOMP 6
+
+/**
+ * Trace operation of gmpmee_fpowm.
+ */
+#define GMPMEE_TRACE_FPOWM 7
+
+/**
+ * Trace operation of gmpmee_fpowm_batch.
+ */
+#define GMPMEE_TRACE_FPOWM_BATCH 8
+
+/**
+ * Trace operation of gmpmee_array_powm.
+ */
+#define GMPMEE_TRACE_ARRAY_POWM 9
+
+/**
+ * Number of trace operations plus one.
+ */
+#define GMPMEE_TRACE_OPS 10
+
+/**
+ * Shape and duration of a single call recorded by tracing. The
+ * values of the integers are not recorded.
+ */
+typedef struct
+{
+  int op;                  /**< Operation, e.g., GMPMEE_TRACE_SPOWM. */
+  size_t len;              /**< Number of bases/exponents. */
+  size_t modulus_bitlen;   /**< Bit length of the modulus. */
+  size_t exponent_bitlen;  /**< Largest bit length of the exponents,
+			      or zero for precomputation. */
+  size_t block_width;      /**< Block width used, also if chosen by
+			      the routine, or zero if the routine
+			      does not use blocks. */
+  size_t batch_len;        /**< Batch length, or for fixed-base
+			      exponentiation the bit length of
+			      exponents the table is built for. */
+  double seconds;          /**< Duration of the call. */
+} gmpmee_trace_record_struct;
+
+/**
+ * Record of a single call.
+ */
+typedef gmpmee_trace_record_struct
+gmpmee_trace_record[1]; /* Magic references. */
+
+/**
+ * Callback invoked for each traced call with the record of the call
+ * and the argument given at registration.
+ */
+typedef void
+(*gmpmee_trace_callback)(gmpmee_trace_record_struct *record, void *arg);
+
+/**
+ * Registers a callback that is invoked at the end of each top-level
+ * call of a traced routine, i.e., the exponentiation routines
+ * corresponding to the GMPMEE_TRACE_* operations. Calls made by a
+ * traced routine are not reported separately. The callback may be
+ * invoked by several threads concurrently. It must not be changed
+ * while other threads use the library.
+ *
+ * @param callback Callback, or NULL to stop tracing.
+ * @param arg Argument passed to the callback.
+ */
+void
+gmpmee_trace_set(gmpmee_trace_callback callback, void *arg);
+
+/**
+ * Returns the name of the operation, e.g., "spowm" for
+ * GMPMEE_TRACE_SPOWM, or NULL if the operation is unknown.
+ *
+ * @param op Operation.
+ */
+const char *
+gmpmee_trace_name(int op);
+
+/**
+ * Writes the record to the stream as a single line of text. This
+ * may be registered as a callback with a stream as argument to
+ * record a trace of a workload.
+ *
+ * @param record Record to write.
+ * @param stream Destination stream.
+ */
+void
+gmpmee_trace_fprint(gmpmee_trace_record_struct *record, void *stream);
+
+/**
+ * Reads the next record written by gmpmee_trace_fprint from the
+ * stream. Empty lines and lines starting with '#' are skipped.
+ *
+ * @param record Destination of the record.
+ * @param stream Source stream.
+ * @return 1 if a record is read and 0 at the end of the stream or on
+ * a malformed line.
+ */
+int
+gmpmee_trace_fread(gmpmee_trace_record record, FILE *stream);
+
+/**
+ * Called by a traced routine before it starts. Returns 1 if the call
+ * is traced, in which case the operation and the shape of the
+ * arguments are stored in the record and the clock is started, and
+ * 0 otherwise. The routine must call gmpmee_trace_leave when it
+ * completes if 1 is returned. If no callback is registered, then
+ * this only reads gmpmee_trace_hook and no function is called.
+ *
+ * @param record Record of the call.
+ * @param op Operation.
+ * @param modulus Modulus.
+ * @param exponents Exponents, or NULL.
+ * @param len Number of bases/exponents.
+ */
+#define gmpmee_trace_enter(record, op, modulus, exponents, len)	\
+  (gmpmee_trace_hook != NULL						\
+   && gmpmee_trace_begin(record, op, modulus, exponents, len))
+
+/**
+ * Implements gmpmee_trace_enter when a callback is registered.
+ *
+ * @param record Record of the call.
+ * @param op Operation.
+ * @param modulus Modulus.
+ * @param exponents Exponents, or NULL.
+ * @param len Number of bases/exponents.
+ */
+int
+gmpmee_trace_begin(gmpmee_trace_record record, int op, mpz_t modulus,
+		   mpz_t *exponents, size_t len);
+
+/**
+ * Called by a traced routine when it completes to report the record
+ * to the callback.
+ *
+ * @param record Record of the call.
+ */
+void
+gmpmee_trace_leave(gmpmee_trace_record record);
+
+/**
+ * Registered callback, or NULL. Used internally.
+ */
+extern gmpmee_trace_callback gmpmee_trace_hook;
+
+/**
+ * Argument of the registered callback. Used internally.
+ */
+extern void *gmpmee_trace_hook_arg;
+
+/**
+ * Indicates if the calling thread is executing a traced call. Used
+ * internally.
+ */
+extern __thread int gmpmee_trace_active;
 
 /* #################### Utility Functions #################### */
 
@@ -617,4 +2885,90 @@ void
 gmpmee_array_urandomb(mpz_t *rop, size_t len, gmp_randstate_t state,
 		      unsigned long int n);
 
+/**
+ * Byte order of fixed-width integers where the most significant
+ * byte comes first. This is the order of Java's BigInteger.
+ */
+#define GMPMEE_BIG_ENDIAN 1
+
+/**
+ * Byte order of fixed-width integers where the least significant
+ * byte comes first.
+ */
+#define GMPMEE_LITTLE_ENDIAN -1
+
+/**
+ * Number of bytes buffered when reading or writing arrays from or to
+ * files.
+ */
+#define GMPMEE_ARRAY_CHUNK_BYTES 65536
+
+/**
+ * Sets the <code>len</code> initialized integers of rop to the
+ * non-negative integers stored in a contiguous buffer, where each
+ * integer is stored in exactly <code>size</code> bytes.
+ *
+ * @param rop Destination of result.
+ * @param len Number of elements in array.
+ * @param op Buffer of <code>len * size</code> bytes.
+ * @param size Number of bytes of each integer.
+ * @param endian Byte order, i.e., GMPMEE_BIG_ENDIAN or
+ * GMPMEE_LITTLE_ENDIAN.
+ */
+void
+gmpmee_array_import(mpz_t *rop, size_t len, const void *op, size_t size,
+		    int endian);
+
+/**
+ * Writes the integers of op to a contiguous buffer, where each
+ * integer is padded with zeros to exactly <code>size</code>
+ * bytes. Processing stops at the first integer that is negative or
+ * does not fit in <code>size</code> bytes.
+ *
+ * @param rop Buffer of at least <code>len * size</code> bytes.
+ * @param op Array of integers.
+ * @param len Number of elements in array.
+ * @param size Number of bytes of each integer.
+ * @param endian Byte order, i.e., GMPMEE_BIG_ENDIAN or
+ * GMPMEE_LITTLE_ENDIAN.
+ * @return Number of integers written.
+ */
+size_t
+gmpmee_array_export(void *rop, mpz_t *op, size_t len, size_t size,
+		    int endian);
+
+/**
+ * Equivalent to gmpmee_array_import, except that the bytes are read
+ * from a stream in chunks of bounded size. Reading stops at the end
+ * of the stream or on error. Nothing is read if size is zero.
+ *
+ * @param rop Destination of result.
+ * @param len Number of elements in array.
+ * @param size Number of bytes of each integer.
+ * @param endian Byte order, i.e., GMPMEE_BIG_ENDIAN or
+ * GMPMEE_LITTLE_ENDIAN.
+ * @param stream Source stream.
+ * @return Number of integers read, which is zero on error.
+ */
+size_t
+gmpmee_array_fread(mpz_t *rop, size_t len, size_t size, int endian,
+		   FILE *stream);
+
+/**
+ * Equivalent to gmpmee_array_export, except that the bytes are
+ * written to a stream in chunks of bounded size. Nothing is written
+ * if size is zero.
+ *
+ * @param stream Destination stream.
+ * @param op Array of integers.
+ * @param len Number of elements in array.
+ * @param size Number of bytes of each integer.
+ * @param endian Byte order, i.e., GMPMEE_BIG_ENDIAN or
+ * GMPMEE_LITTLE_ENDIAN.
+ * @return Number of integers written.
+ */
+size_t
+gmpmee_array_fwrite(FILE *stream, mpz_t *op, size_t len, size_t size,
+		    int endian);
+
 #endif /* GMPMEE_H */
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+const gmpmee_kernels_struct *gmpmee_kernels = &gmpmee_kernels_generic;
+
+#ifdef __GNUC__
+
+/*
+ * Selects the kernels when the library is loaded, so the Montgomery
+ * arithmetic never needs to check the processor.
+ */
+static void __attribute__((constructor))
+kernels_init(void)
+{
+  const gmpmee_kernels_struct *kernels = NULL;
+  const char *name = getenv("GMPMEE_KERNELS");
+
+  if (name != NULL)
+    {
+      kernels = gmpmee_kernels_lookup(name);
+    }
+  if (kernels == NULL)
+    {
+      kernels = gmpmee_kernels_lookup(NULL);
+    }
+  gmpmee_kernels = kernels;
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+#ifdef GMPMEE_HAVE_ADX
+
+/*
+ * Adds q times the n limbs of mp to the n limbs of up and returns
+ * the carry, where n is a positive multiple of four. The products
+ * are computed by mulx, and two independent carry chains are kept in
+ * the carry flag (adcx) and the overflow flag (adox), so the high
+ * half of each product and the previous value of the limb are added
+ * without waiting for each other. Neither lea nor jrcxz modifies the
+ * flags, so the chains survive the loop control.
+ */
+static mp_limb_t
+addmul_4k(mp_limb_t *up, const mp_limb_t *mp, mp_size_t n, mp_limb_t q)
+{
+  mp_limb_t h0 = 0;
+  mp_limb_t h1;
+  mp_limb_t l0;
+  mp_limb_t l1;
+  mp_size_t k = n >> 2;
+
+  __asm__ volatile ("xor %%eax, %%eax\n\t"
+		    "1:\n\t"
+		    "mulx (%[m]), %[l0], %[h1]\n\t"
+		    "adcx %[h0], %[l0]\n\t"
+		    "adox (%[u]), %[l0]\n\t"
+		    "mov %[l0], (%[u])\n\t"
+		    "mulx 8(%[m]), %[l1], %[h0]\n\t"
+		    "adcx %[h1], %[l1]\n\t"
+		    "adox 8(%[u]), %[l1]\n\t"
+		    "mov %[l1], 8(%[u])\n\t"
+		    "mulx 16(%[m]), %[l0], %[h1]\n\t"
+		    "adcx %[h0], %[l0]\n\t"
+		    "adox 16(%[u]), %[l0]\n\t"
+		    "mov %[l0], 16(%[u])\n\t"
+		    "mulx 24(%[m]), %[l1], %[h0]\n\t"
+		    "adcx %[h1], %[l1]\n\t"
+		    "adox 24(%[u]), %[l1]\n\t"
+		    "mov %[l1], 24(%[u])\n\t"
+		    "lea 32(%[m]), %[m]\n\t"
+		    "lea 32(%[u]), %[u]\n\t"
+		    "lea -1(%[k]), %[k]\n\t"
+		    "jrcxz 2f\n\t"
+		    "jmp 1b\n\t"
+		    "2:\n\t"
+		    "mov $0, %%eax\n\t"
+		    "adcx %%rax, %[h0]\n\t"
+		    "adox %%rax, %[h0]\n\t"
+		    : [h0] "+&r" (h0), [h1] "=&r" (h1),
+		      [l0] "=&r" (l0), [l1] "=&r" (l1),
+		      [u] "+r" (up), [m] "+r" (mp), [k] "+c" (k)
+		    : "d" (q)
+		    : "rax", "cc", "memory");
+  return h0;
+}
+
+/*
+ * Adds q times the n limbs of mp to the n limbs of up and returns
+ * the carry.
+ */
+static mp_limb_t
+addmul_1(mp_limb_t *up, const mp_limb_t *mp, mp_size_t n, mp_limb_t q)
+{
+  mp_size_t n4 = n & ~((mp_size_t)3);
+  mp_limb_t cy = 0;
+
+  if (n4 > 0)
+    {
+      cy = addmul_4k(up, mp, n4, q);
+    }
+  if (n4 < n)
+    {
+      cy = mpn_add_1(up + n4, up + n4, n - n4, cy)
+	+ mpn_addmul_1(up + n4, mp + n4, n - n4, q);
+    }
+  return cy;
+}
+
+static void
+redc(mp_limb_t *rp, mp_limb_t *tp, const mp_limb_t *mp, mp_size_t n,
+     mp_limb_t minv)
+{
+  mp_size_t j;
+  mp_limb_t cy;
+  mp_limb_t *up = tp;
+
+  /* Same algorithm as the generic kernel. */
+  for (j = 0; j < n; j++)
+    {
+      up[0] = addmul_1(up, mp, n, up[0] * minv);
+      up++;
+    }
+  cy = mpn_add_n(rp, up, tp, n);
+
+  if (cy != 0 || mpn_cmp(rp, mp, n) >= 0)
+    {
+      mpn_sub_n(rp, rp, mp, n);
+    }
+}
+
+/*
+ * The products are computed by GMP, which already uses the best
+ * multiplication algorithm for the processor and the size.
+ */
+static void
+mul(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *bp,
+    const mp_limb_t *mp, mp_size_t n, mp_limb_t minv, mp_limb_t *tp)
+{
+  mpn_mul_n(tp, ap, bp, n);
+  redc(rp, tp, mp, n, minv);
+}
+
+static void
+sqr(mp_limb_t *rp, const mp_limb_t *ap,
+    const mp_limb_t *mp, mp_size_t n, mp_limb_t minv, mp_limb_t *tp)
+{
+  mpn_sqr(tp, ap, n);
+  redc(rp, tp, mp, n, minv);
+}
+
+const gmpmee_kernels_struct gmpmee_kernels_adx = {
+  "bmi2-adx", redc, mul, sqr
+};
+
+#endif
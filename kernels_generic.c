@@ -0,0 +1,69 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+static void
+redc(mp_limb_t *rp, mp_limb_t *tp, const mp_limb_t *mp, mp_size_t n,
+     mp_limb_t minv)
+{
+  mp_size_t j;
+  mp_limb_t q;
+  mp_limb_t cy;
+  mp_limb_t *up = tp;
+
+  /* Clear one limb at a time from below by adding a multiple of the
+     modulus. The carry out of each step is stored in the cleared
+     limb and added at the end. */
+  for (j = 0; j < n; j++)
+    {
+      q = up[0] * minv;
+      cy = mpn_addmul_1(up, mp, n, q);
+      up[0] = cy;
+      up++;
+    }
+  cy = mpn_add_n(rp, up, tp, n);
+
+  /* The result is smaller than twice the modulus. */
+  if (cy != 0 || mpn_cmp(rp, mp, n) >= 0)
+    {
+      mpn_sub_n(rp, rp, mp, n);
+    }
+}
+
+static void
+mul(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *bp,
+    const mp_limb_t *mp, mp_size_t n, mp_limb_t minv, mp_limb_t *tp)
+{
+  mpn_mul_n(tp, ap, bp, n);
+  redc(rp, tp, mp, n, minv);
+}
+
+static void
+sqr(mp_limb_t *rp, const mp_limb_t *ap,
+    const mp_limb_t *mp, mp_size_t n, mp_limb_t minv, mp_limb_t *tp)
+{
+  mpn_sqr(tp, ap, n);
+  redc(rp, tp, mp, n, minv);
+}
+
+const gmpmee_kernels_struct gmpmee_kernels_generic = {
+  "generic", redc, mul, sqr
+};
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+#ifdef GMPMEE_HAVE_ADX
+
+#include <cpuid.h>
+
+/*
+ * Returns non-zero if the processor supports BMI2 (mulx) and ADX
+ * (adcx and adox), i.e., bits 8 and 19 of ebx of leaf seven.
+ */
+static int
+cpu_has_adx(void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  if (__get_cpuid_max(0, NULL) < 7)
+    {
+      return 0;
+    }
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  (void)eax;
+  (void)ecx;
+  (void)edx;
+  return (ebx & (1U << 8)) && (ebx & (1U << 19));
+}
+
+#endif
+
+const gmpmee_kernels_struct *
+gmpmee_kernels_lookup(const char *name)
+{
+#ifdef GMPMEE_HAVE_ADX
+  if ((name == NULL || strcmp(name, gmpmee_kernels_adx.name) == 0)
+      && cpu_has_adx())
+    {
+      return &gmpmee_kernels_adx;
+    }
+#endif
+  if (name == NULL || strcmp(name, gmpmee_kernels_generic.name) == 0)
+    {
+      return &gmpmee_kernels_generic;
+    }
+  return NULL;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+unsigned int
+gmpmee_lanes(void)
+{
+#ifdef GMPMEE_HAVE_LANES
+  if (__builtin_cpu_supports("avx512f")
+      && __builtin_cpu_supports("avx512ifma"))
+    {
+      return GMPMEE_LANES_IFMA;
+    }
+  if (__builtin_cpu_supports("avx2"))
+    {
+      return GMPMEE_LANES_AVX2;
+    }
+#endif
+  return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+uint64_t *
+gmpmee_lanes_alloc(size_t len)
+{
+  char *p;
+  char *q;
+
+  if (len > (SIZE_MAX - GMPMEE_LANES_ALIGN - sizeof(void *))
+      / sizeof(uint64_t))
+    {
+      return NULL;
+    }
+
+  /* The original pointer is stored just before the aligned block. */
+  p = (char *)malloc(len * sizeof(uint64_t) + GMPMEE_LANES_ALIGN
+		     + sizeof(void *));
+  if (p == NULL)
+    {
+      return NULL;
+    }
+  q = p + sizeof(void *);
+  q += (GMPMEE_LANES_ALIGN - ((uintptr_t)q % GMPMEE_LANES_ALIGN))
+    % GMPMEE_LANES_ALIGN;
+  ((void **)q)[-1] = p;
+
+  return (uint64_t *)q;
+}
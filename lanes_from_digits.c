@@ -0,0 +1,52 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_from_digits(mpz_t rop, const uint64_t *d, size_t n,
+			 unsigned int lanes, unsigned int lane,
+			 unsigned int bits)
+{
+  size_t j;
+  size_t pos;
+  size_t limb;
+  unsigned int off;
+  uint64_t v;
+  mp_size_t size = (n * bits + 63) / 64;
+  mp_limb_t *rp = mpz_limbs_write(rop, size);
+
+  mpn_zero(rp, size);
+  for (j = 0; j < n; j++)
+    {
+      pos = j * bits;
+      limb = pos / 64;
+      off = pos % 64;
+      v = d[j * lanes + lane];
+
+      rp[limb] |= v << off;
+      if (off + bits > 64)
+	{
+	  rp[limb + 1] |= v >> (64 - off);
+	}
+    }
+  mpz_limbs_finish(rop, size);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_mont_clear(gmpmee_lanes_mont mont)
+{
+  unsigned int l;
+
+  for (l = 0; l < mont->lanes; l++)
+    {
+      mpz_clear(mont->moduli[l]);
+    }
+  mpz_clear(mont->tmp);
+  gmpmee_lanes_free(mont->tp);
+  gmpmee_lanes_free(mont->xp);
+  gmpmee_lanes_free(mont->unit);
+  gmpmee_lanes_free(mont->r2);
+  gmpmee_lanes_free(mont->m);
+}
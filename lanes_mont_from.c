@@ -0,0 +1,42 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_mont_from(gmpmee_lanes_mont mont, mpz_t *rops,
+		       const uint64_t *ap, size_t len)
+{
+  unsigned int l;
+
+  /* Multiplying by one gives a result that is at most m. */
+  gmpmee_lanes_mont_mul(mont, mont->xp, ap, mont->unit);
+
+  for (l = 0; l < len; l++)
+    {
+      gmpmee_lanes_from_digits(rops[l], mont->xp, mont->n, mont->lanes, l,
+			       mont->bits);
+      if (mpz_cmp(rops[l], mont->moduli[l]) == 0)
+	{
+	  mpz_set_ui(rops[l], 0);
+	}
+    }
+}
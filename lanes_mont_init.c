@@ -0,0 +1,122 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns -1/m0 modulo 2^64 for an odd integer m0.
+ */
+static uint64_t
+minus_inverse(uint64_t m0)
+{
+  int i;
+  uint64_t inv = m0;
+
+  for (i = 0; i < 5; i++)
+    {
+      inv *= 2 - m0 * inv;
+    }
+  return -inv;
+}
+
+int
+gmpmee_lanes_mont_init(gmpmee_lanes_mont mont, mpz_t *moduli, size_t len,
+		       unsigned int lanes)
+{
+  unsigned int l;
+  size_t j;
+  size_t mbits;
+  size_t n;
+  size_t size;
+  mpz_t *modulus;
+
+  mbits = 0;
+  for (l = 0; l < len; l++)
+    {
+      if (mpz_sizeinbase(moduli[l], 2) > mbits)
+	{
+	  mbits = mpz_sizeinbase(moduli[l], 2);
+	}
+    }
+
+  /* The AVX2 kernel uses 28-bit digits unless the accumulated
+     products could overflow, in which case 26-bit digits are used. */
+  mont->lanes = lanes;
+  mont->mul = NULL;
+#ifdef GMPMEE_HAVE_LANES
+  if (lanes == GMPMEE_LANES_IFMA)
+    {
+      mont->mul = gmpmee_lanes_mul_ifma;
+      mont->bits = 52;
+    }
+  else
+    {
+      mont->mul = gmpmee_lanes_mul_avx2;
+      mont->bits = (mbits + 2 + 27) / 28 <= 120 ? 28 : 26;
+    }
+#else
+  mont->bits = 52;
+#endif
+
+  /* R = 2^(n * bits) > 4m */
+  n = (mbits + 2 + mont->bits - 1) / mont->bits;
+  size = n * lanes;
+  mont->n = n;
+  mont->size = size;
+
+  mont->m = gmpmee_lanes_alloc(size);
+  mont->r2 = gmpmee_lanes_alloc(size);
+  mont->unit = gmpmee_lanes_alloc(size);
+  mont->xp = gmpmee_lanes_alloc(size);
+  mont->tp = gmpmee_lanes_alloc(2 * size + lanes);
+  if (mont->m == NULL || mont->r2 == NULL || mont->unit == NULL
+      || mont->xp == NULL || mont->tp == NULL)
+    {
+      gmpmee_lanes_free(mont->tp);
+      gmpmee_lanes_free(mont->xp);
+      gmpmee_lanes_free(mont->unit);
+      gmpmee_lanes_free(mont->r2);
+      gmpmee_lanes_free(mont->m);
+      return 0;
+    }
+  mpz_init(mont->tmp);
+
+  for (l = 0; l < lanes; l++)
+    {
+      modulus = l < len ? &moduli[l] : &moduli[0];
+      mpz_init_set(mont->moduli[l], *modulus);
+
+      gmpmee_lanes_to_digits(mont->m, n, lanes, l, mont->bits, *modulus);
+      mont->k0[l] = minus_inverse(mpz_getlimbn(*modulus, 0))
+	& (((uint64_t)1 << mont->bits) - 1);
+
+      mpz_set_ui(mont->tmp, 0);
+      mpz_setbit(mont->tmp, 2 * n * mont->bits);
+      mpz_mod(mont->tmp, mont->tmp, *modulus);
+      gmpmee_lanes_to_digits(mont->r2, n, lanes, l, mont->bits, mont->tmp);
+    }
+
+  for (j = 0; j < size; j++)
+    {
+      mont->unit[j] = j < lanes;
+    }
+  return 1;
+}
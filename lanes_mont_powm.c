@@ -0,0 +1,146 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns the width of the fixed windows used for exponents of the
+ * given bit length, i.e., the width that minimizes the sum of the
+ * number of windows and the size of the table.
+ */
+static unsigned int
+window_width(size_t ebits)
+{
+  unsigned int w = 1;
+
+  while (w < 8 && ebits / (w + 1) + ((size_t)1 << (w + 1))
+	 < ebits / w + ((size_t)1 << w))
+    {
+      w++;
+    }
+  return w;
+}
+
+/*
+ * Returns the window of the given width starting at the given bit.
+ */
+static unsigned int
+window(mpz_t exp, size_t bit, unsigned int w)
+{
+  unsigned int i;
+  unsigned int v = 0;
+
+  for (i = w; i > 0; i--)
+    {
+      v = (v << 1) | mpz_tstbit(exp, bit + i - 1);
+    }
+  return v;
+}
+
+int
+gmpmee_lanes_mont_powm(gmpmee_lanes_mont mont, mpz_t *rops, mpz_t *bases,
+		       mpz_t *exps, size_t len)
+{
+  unsigned int l;
+  unsigned int src;
+  unsigned int w;
+  size_t j;
+  size_t e;
+  size_t ebits;
+  size_t win;
+  size_t nwin;
+  size_t entries;
+  unsigned int lanes = mont->lanes;
+  size_t n = mont->n;
+  size_t size = mont->size;
+  uint64_t *table;
+  uint64_t *x;
+  uint64_t *y;
+
+  /* Lanes beyond the given integers duplicate the first lane. */
+  ebits = 0;
+  for (l = 0; l < len; l++)
+    {
+      if (mpz_sizeinbase(exps[l], 2) > ebits)
+	{
+	  ebits = mpz_sizeinbase(exps[l], 2);
+	}
+    }
+
+  w = window_width(ebits);
+  entries = (size_t)1 << w;
+  nwin = (ebits + w - 1) / w;
+
+  x = gmpmee_lanes_alloc(size);
+  y = gmpmee_lanes_alloc(size);
+  table = gmpmee_lanes_alloc(entries * size);
+  if (x == NULL || y == NULL || table == NULL)
+    {
+      gmpmee_lanes_free(table);
+      gmpmee_lanes_free(y);
+      gmpmee_lanes_free(x);
+      return 0;
+    }
+
+  /* The first two entries of the table hold R mod m and b * R mod m,
+     respectively, where R = R^2 / R. */
+  gmpmee_lanes_mont_mul(mont, table, mont->r2, mont->unit);
+  gmpmee_lanes_mont_to(mont, table + size, bases, len);
+
+  for (e = 2; e < entries; e++)
+    {
+      gmpmee_lanes_mont_mul(mont, table + e * size, table + (e - 1) * size,
+			    table + size);
+    }
+
+  /* Fixed windows starting with the most significant window. Each
+     lane picks its own table entry. */
+  memcpy(y, table, size * sizeof(uint64_t));
+  for (win = nwin; win > 0; win--)
+    {
+      if (win < nwin)
+	{
+	  for (j = 0; j < w; j++)
+	    {
+	      gmpmee_lanes_mont_sqr(mont, y, y);
+	    }
+	}
+
+      for (l = 0; l < lanes; l++)
+	{
+	  src = l < len ? l : 0;
+	  e = window(exps[src], (win - 1) * w, w);
+	  for (j = 0; j < n; j++)
+	    {
+	      x[j * lanes + l] = table[e * size + j * lanes + l];
+	    }
+	}
+      gmpmee_lanes_mont_mul(mont, y, y, x);
+    }
+
+  gmpmee_lanes_mont_from(mont, rops, y, len);
+
+  gmpmee_lanes_free(table);
+  gmpmee_lanes_free(y);
+  gmpmee_lanes_free(x);
+  return 1;
+}
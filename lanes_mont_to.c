@@ -0,0 +1,46 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_mont_to(gmpmee_lanes_mont mont, uint64_t *rp, mpz_t *ops,
+		     size_t len)
+{
+  unsigned int l;
+  mpz_t *op;
+
+  /* The kernel requires inputs smaller than twice the modulus. */
+  for (l = 0; l < mont->lanes; l++)
+    {
+      op = l < len ? &ops[l] : &ops[0];
+      if (mpz_sgn(*op) < 0 || mpz_cmp(*op, mont->moduli[l]) >= 0)
+	{
+	  mpz_mod(mont->tmp, *op, mont->moduli[l]);
+	  op = &mont->tmp;
+	}
+      gmpmee_lanes_to_digits(mont->xp, mont->n, mont->lanes, l, mont->bits,
+			     *op);
+    }
+
+  /* a * R^2 / R = a * R */
+  gmpmee_lanes_mont_mul(mont, rp, mont->xp, mont->r2);
+}
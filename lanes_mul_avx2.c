@@ -0,0 +1,149 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+#ifdef GMPMEE_HAVE_LANES
+
+#include <immintrin.h>
+
+/*
+ * AVX2 kernel with four lanes of digits of at most 28 bits. Products
+ * of digits are accumulated in 64 bits without normalization, which
+ * is safe as long as 2n + 4 products smaller than 2^(2 * bits) fit
+ * in 64 bits. The accumulator is shifted as in the IFMA kernel.
+ */
+__attribute__((target("avx2")))
+void
+gmpmee_lanes_mul_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b,
+		      const uint64_t *m, const uint64_t *k0, uint64_t *t,
+		      size_t n, unsigned int bits)
+{
+  size_t i;
+  size_t j;
+  uint64_t *u;
+  __m256i ai;
+  __m256i ai1;
+  __m256i q;
+  __m256i q1;
+  __m256i bj;
+  __m256i bj1;
+  __m256i mj;
+  __m256i mj1;
+  __m256i c;
+  __m256i zero = _mm256_setzero_si256();
+  __m256i mask = _mm256_set1_epi64x(((uint64_t)1 << bits) - 1);
+  __m128i shift = _mm_cvtsi32_si128(bits);
+  __m256i k = _mm256_loadu_si256((const __m256i *)k0);
+
+#define LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define STORE(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+
+  for (j = 0; j < 2 * n + 1; j++)
+    {
+      STORE(t + 4 * j, zero);
+    }
+
+  /* Two rows are processed in each iteration to halve the number of
+     loads and stores of the accumulator. An odd number of digits is
+     handled by a final single row. */
+  for (i = 0; i + 1 < n; i += 2)
+    {
+      u = t + 4 * i;
+      ai = LOAD(a + 4 * i);
+      ai1 = LOAD(a + 4 * (i + 1));
+
+      /* u + a_i * b + q * m is divisible by 2^bits. */
+      c = _mm256_add_epi64(LOAD(u), _mm256_mul_epu32(ai, LOAD(b)));
+      q = _mm256_and_si256(_mm256_mul_epu32(c, k), mask);
+      c = _mm256_add_epi64(c, _mm256_mul_epu32(q, LOAD(m)));
+
+      /* Second digit of the first row and the carry from the first
+	 digit determine the quotient digit of the second row. */
+      c = _mm256_add_epi64(_mm256_srl_epi64(c, shift),
+			   _mm256_add_epi64(LOAD(u + 4),
+					    _mm256_add_epi64(_mm256_mul_epu32(ai, LOAD(b + 4)),
+							     _mm256_mul_epu32(q, LOAD(m + 4)))));
+      c = _mm256_add_epi64(c, _mm256_mul_epu32(ai1, LOAD(b)));
+      q1 = _mm256_and_si256(_mm256_mul_epu32(c, k), mask);
+      c = _mm256_add_epi64(c, _mm256_mul_epu32(q1, LOAD(m)));
+
+      bj = LOAD(b + 4);
+      mj = LOAD(m + 4);
+      for (j = 2; j < n; j++)
+	{
+	  bj1 = bj;
+	  mj1 = mj;
+	  bj = LOAD(b + 4 * j);
+	  mj = LOAD(m + 4 * j);
+	  STORE(u + 4 * j,
+		_mm256_add_epi64(_mm256_add_epi64(LOAD(u + 4 * j),
+						  _mm256_add_epi64(_mm256_mul_epu32(ai, bj),
+								   _mm256_mul_epu32(q, mj))),
+				 _mm256_add_epi64(_mm256_mul_epu32(ai1, bj1),
+						  _mm256_mul_epu32(q1, mj1))));
+	}
+      STORE(u + 4 * n,
+	    _mm256_add_epi64(_mm256_mul_epu32(ai1, bj),
+			     _mm256_mul_epu32(q1, mj)));
+
+      /* Divide by 2^(2 * bits). */
+      STORE(u + 8, _mm256_add_epi64(LOAD(u + 8), _mm256_srl_epi64(c, shift)));
+    }
+
+  if (i < n)
+    {
+      u = t + 4 * i;
+      ai = LOAD(a + 4 * i);
+
+      c = _mm256_add_epi64(LOAD(u), _mm256_mul_epu32(ai, LOAD(b)));
+      q = _mm256_and_si256(_mm256_mul_epu32(c, k), mask);
+      c = _mm256_add_epi64(c, _mm256_mul_epu32(q, LOAD(m)));
+
+      for (j = 1; j < n; j++)
+	{
+	  STORE(u + 4 * j,
+		_mm256_add_epi64(LOAD(u + 4 * j),
+				 _mm256_add_epi64(_mm256_mul_epu32(ai,
+								   LOAD(b + 4 * j)),
+						  _mm256_mul_epu32(q,
+								   LOAD(m + 4 * j)))));
+	}
+
+      /* Divide by 2^bits. */
+      STORE(u + 4, _mm256_add_epi64(LOAD(u + 4), _mm256_srl_epi64(c, shift)));
+    }
+
+  /* Normalize. */
+  u = t + 4 * n;
+  c = zero;
+  for (j = 0; j < n; j++)
+    {
+      c = _mm256_add_epi64(LOAD(u + 4 * j), c);
+      STORE(r + 4 * j, _mm256_and_si256(c, mask));
+      c = _mm256_srl_epi64(c, shift);
+    }
+
+#undef STORE
+#undef LOAD
+}
+
+#endif
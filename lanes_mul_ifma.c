@@ -0,0 +1,113 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+#ifdef GMPMEE_HAVE_LANES
+
+#include <immintrin.h>
+
+/*
+ * AVX-512 IFMA kernel with eight lanes of 52-bit digits. Products of
+ * digits are split into their low and high 52 bits and accumulated
+ * in 64 bits without normalization, which is safe as long as 4n
+ * terms smaller than 2^52 fit in 64 bits.
+ *
+ * The accumulator is shifted one digit in each iteration by moving
+ * its start in the temporary space instead of moving its digits. The
+ * low and high parts are added in separate passes to avoid
+ * dependencies between consecutive digits.
+ */
+__attribute__((target("avx512f,avx512ifma")))
+void
+gmpmee_lanes_mul_ifma(uint64_t *r, const uint64_t *a, const uint64_t *b,
+		      const uint64_t *m, const uint64_t *k0, uint64_t *t,
+		      size_t n, unsigned int bits)
+{
+  size_t i;
+  size_t j;
+  uint64_t *u;
+  __m512i ai;
+  __m512i q;
+  __m512i c;
+  __m512i zero = _mm512_setzero_si512();
+  __m512i mask = _mm512_set1_epi64(((uint64_t)1 << 52) - 1);
+  __m512i k = _mm512_loadu_si512(k0);
+
+  GMPMEE_UNUSED(bits);
+
+#define LOAD(p) _mm512_loadu_si512(p)
+#define STORE(p, v) _mm512_storeu_si512(p, v)
+
+  for (j = 0; j < 2 * n + 1; j++)
+    {
+      STORE(t + 8 * j, zero);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      u = t + 8 * i;
+      ai = LOAD(a + 8 * i);
+
+      /* u + a_i * b + q * m is divisible by 2^52. */
+      c = _mm512_madd52lo_epu64(LOAD(u), ai, LOAD(b));
+      q = _mm512_madd52lo_epu64(zero, c, k);
+      c = _mm512_madd52lo_epu64(c, q, LOAD(m));
+
+      /* Low parts. */
+      for (j = 1; j < n; j++)
+	{
+	  STORE(u + 8 * j,
+		_mm512_madd52lo_epu64(_mm512_madd52lo_epu64(LOAD(u + 8 * j),
+							    ai,
+							    LOAD(b + 8 * j)),
+				      q, LOAD(m + 8 * j)));
+	}
+
+      /* High parts. */
+      for (j = 0; j < n; j++)
+	{
+	  STORE(u + 8 * (j + 1),
+		_mm512_madd52hi_epu64(_mm512_madd52hi_epu64(LOAD(u + 8 * (j + 1)),
+							    ai,
+							    LOAD(b + 8 * j)),
+				      q, LOAD(m + 8 * j)));
+	}
+
+      /* Divide by 2^52. */
+      STORE(u + 8, _mm512_add_epi64(LOAD(u + 8), _mm512_srli_epi64(c, 52)));
+    }
+
+  /* Normalize. */
+  u = t + 8 * n;
+  c = zero;
+  for (j = 0; j < n; j++)
+    {
+      c = _mm512_add_epi64(LOAD(u + 8 * j), c);
+      STORE(r + 8 * j, _mm512_and_si512(c, mask));
+      c = _mm512_srli_epi64(c, 52);
+    }
+
+#undef STORE
+#undef LOAD
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_powm(mpz_t *rops, mpz_t *bases, mpz_t *exps, mpz_t *moduli,
+		  size_t len, unsigned int lanes)
+{
+  int res;
+  size_t i;
+  size_t j;
+  size_t chunk;
+  gmpmee_lanes_mont mont;
+
+  if (lanes != GMPMEE_LANES_IFMA && lanes != GMPMEE_LANES_AVX2)
+    {
+      lanes = 1;
+    }
+#ifndef GMPMEE_HAVE_LANES
+  lanes = 1;
+#endif
+
+  for (i = 0; i < len; i += chunk)
+    {
+      chunk = len - i < lanes ? len - i : lanes;
+
+      /* Moduli that are too large for the kernels are handled by
+	 GMP. */
+      for (j = 0; j < chunk; j++)
+	{
+	  if (mpz_sizeinbase(moduli[i + j], 2) > GMPMEE_LANES_MAX_BITLEN)
+	    {
+	      break;
+	    }
+	}
+
+      /* If memory for the kernels can not be allocated, then GMP is
+	 used instead. */
+      if (lanes > 1 && j == chunk
+	  && gmpmee_lanes_mont_init(mont, moduli + i, chunk, lanes))
+	{
+	  res = gmpmee_lanes_mont_powm(mont, rops + i, bases + i, exps + i,
+				       chunk);
+	  gmpmee_lanes_mont_clear(mont);
+	  if (res)
+	    {
+	      continue;
+	    }
+	}
+
+      for (j = 0; j < chunk; j++)
+	{
+	  mpz_powm(rops[i + j], bases[i + j], exps[i + j], moduli[i + j]);
+	  GMPMEE_STATS_INC(powm);
+	}
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_lanes_to_digits(uint64_t *d, size_t n, unsigned int lanes,
+		       unsigned int lane, unsigned int bits, mpz_t op)
+{
+  size_t j;
+  size_t pos;
+  size_t limb;
+  unsigned int off;
+  uint64_t v;
+  uint64_t mask = ((uint64_t)1 << bits) - 1;
+
+  for (j = 0; j < n; j++)
+    {
+      pos = j * bits;
+      limb = pos / 64;
+      off = pos % 64;
+
+      v = mpz_getlimbn(op, limb) >> off;
+      if (off + bits > 64)
+	{
+	  v |= mpz_getlimbn(op, limb + 1) << (64 - off);
+	}
+      d[j * lanes + lane] = v & mask;
+    }
+}
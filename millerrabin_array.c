@@ -0,0 +1,212 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Arguments of a single thread. The threads test interleaved
+ * subsequences of the candidates, so with random bases which source
+ * of randomness is used for a given candidate only depends on the
+ * number of threads, and with hash-derived bases the results do not
+ * depend on the number of threads at all.
+ */
+typedef struct
+{
+  int *results;               /* Destination of results. */
+  const unsigned char *seed;  /* Seed of bases, or NULL. */
+  mpz_t *candidates;          /* Candidates to test. */
+  size_t len;                 /* Number of candidates. */
+  int reps;                   /* Number of repetitions. */
+  size_t first;               /* Index of first candidate of thread. */
+  size_t stride;              /* Distance between candidates of thread. */
+  gmp_randstate_t rstate;     /* Source of randomness of thread, unless
+				 the seed is used. */
+  gmpmee_stats stats;         /* Counters of thread. */
+} array_thread;
+
+/*
+ * Equivalent to gmpmee_millerrabin_rs, or gmpmee_millerrabin_hs if
+ * the seed is not NULL, except that the given state is reused
+ * instead of allocating a new state for each candidate.
+ */
+static int
+test(gmpmee_millerrabin_state state, gmp_randstate_t rstate,
+     const unsigned char *seed, mpz_t n, int reps)
+{
+  if (mpz_fits_ulong_p(n))
+    {
+      return gmpmee_millerrabin_ui(mpz_get_ui(n));
+    }
+  else if (gmpmee_millerrabin_trial(n) == 0)
+    {
+      return 0;
+    }
+  else
+    {
+      mpz_set(state->n, n);
+      gmpmee_millerrabin_update(state);
+
+      /* The repetitions stop at the first failed round. */
+      if (seed != NULL)
+	{
+	  return gmpmee_millerrabin_reps_hs(seed, state, 0, reps);
+	}
+      return gmpmee_millerrabin_reps_rs(rstate, state, reps);
+    }
+}
+
+static void
+test_range(array_thread *thread, gmp_randstate_t rstate)
+{
+  size_t i;
+  gmpmee_millerrabin_state state;
+
+  /* The integer used to initialize the state is irrelevant, since it
+     is replaced by each candidate. */
+  gmpmee_millerrabin_init(state, thread->candidates[thread->first]);
+
+  for (i = thread->first; i < thread->len; i += thread->stride)
+    {
+      thread->results[i] = test(state, rstate, thread->seed,
+				thread->candidates[i], thread->reps);
+    }
+
+  gmpmee_millerrabin_clear(state);
+}
+
+static void *
+array_thread_main(void *arg)
+{
+  array_thread *thread = (array_thread *)arg;
+
+  test_range(thread, thread->rstate);
+  gmpmee_stats_get(thread->stats);
+  return NULL;
+}
+
+void
+gmpmee_millerrabin_array(int *results, gmp_randstate_t rstate,
+			 const unsigned char *seed, mpz_t *candidates,
+			 size_t len, int reps, unsigned int nthreads)
+{
+  size_t i;
+  size_t max_bitlen;
+  size_t started;
+  mpz_t rseed;
+  array_thread *threads;
+  pthread_t *ids;
+
+  if (len == 0)
+    {
+      return;
+    }
+
+  /* Starting threads, and seeding a source of randomness for each of
+     them, costs more than testing small integers. */
+  max_bitlen = 0;
+  for (i = 0; i < len; i++)
+    {
+      if (mpz_sizeinbase(candidates[i], 2) > max_bitlen)
+	{
+	  max_bitlen = mpz_sizeinbase(candidates[i], 2);
+	}
+    }
+  if (nthreads == 0 || max_bitlen < GMPMEE_SEARCH_MT_MIN_BITLEN)
+    {
+      nthreads = 1;
+    }
+  else if ((size_t)nthreads > len)
+    {
+      nthreads = (unsigned int)len;
+    }
+
+  threads = (array_thread *)malloc(nthreads * sizeof(array_thread));
+  for (i = 0; i < nthreads; i++)
+    {
+      threads[i].results = results;
+      threads[i].seed = seed;
+      threads[i].candidates = candidates;
+      threads[i].len = len;
+      threads[i].reps = reps;
+      threads[i].first = i;
+      threads[i].stride = nthreads;
+    }
+
+  if (nthreads == 1)
+    {
+      test_range(&threads[0], rstate);
+      free(threads);
+      return;
+    }
+
+  ids = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+
+  /* Each thread uses its own source of randomness derived from the
+     given source, unless the bases are derived from the seed. */
+  if (seed == NULL)
+    {
+      mpz_init(rseed);
+      for (i = 0; i < nthreads; i++)
+	{
+	  gmp_randinit_default(threads[i].rstate);
+	  mpz_urandomb(rseed, rstate, GMPMEE_SEED_BITS);
+	  gmp_randseed(threads[i].rstate, rseed);
+	}
+      mpz_clear(rseed);
+    }
+
+  /* The candidates of threads that can not be started are tested by
+     the calling thread. */
+  started = 0;
+  for (i = 1; i < nthreads; i++)
+    {
+      if (pthread_create(&ids[i], NULL, array_thread_main,
+			 &threads[i]) == 0)
+	{
+	  started = i;
+	}
+      else
+	{
+	  break; /* LCOV_EXCL_LINE */
+	}
+    }
+  test_range(&threads[0], threads[0].rstate);
+  for (i = started + 1; i < nthreads; i++)
+    {
+      test_range(&threads[i], threads[i].rstate); /* LCOV_EXCL_LINE */
+    }
+  for (i = 1; i <= started; i++)
+    {
+      pthread_join(ids[i], NULL);
+      gmpmee_stats_add(threads[i].stats);
+    }
+
+  if (seed == NULL)
+    {
+      for (i = 0; i < nthreads; i++)
+	{
+	  gmp_randclear(threads[i].rstate);
+	}
+    }
+  free(ids);
+  free(threads);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_bpsw_rs(gmp_randstate_t rstate,
+			   gmpmee_millerrabin_state state, int reps)
+{
+  int res;
+  mpz_t two;
+
+  if (mpz_cmp_ui(state->n, 4) < 0)
+    {
+      return mpz_cmp_ui(state->n, 1) > 0;
+    }
+  if (mpz_even_p(state->n))
+    {
+      return 0;
+    }
+
+  /* Almost all composites fail the strong test with base two, so the
+     more expensive Lucas test is only executed for the few that
+     pass. */
+  mpz_init_set_ui(two, 2);
+  res = gmpmee_millerrabin_once(state, two)
+    && gmpmee_millerrabin_lucas(state)
+    && (reps == 0 || gmpmee_millerrabin_reps_rs(rstate, state, reps));
+  mpz_clear(two);
+
+  return res;
+}
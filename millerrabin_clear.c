@@ -22,6 +22,7 @@
 
 void
 gmpmee_millerrabin_clear(gmpmee_millerrabin_state state) {
+  gmpmee_mont_clear(state->mont);
   mpz_clear(state->y);
   mpz_clear(state->q);
   mpz_clear(state->n_minus_1);
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include "gmpmee.h"
+
+/*
+ * Returns the base two logarithm of a bound on the probability that
+ * a uniformly random odd integer of the given bit length that passes
+ * the given number of rounds is composite, using the bounds of
+ * Damgard, Landrock, and Pomerance, or zero if no bound applies.
+ */
+static double
+dlp_log2(double k, double t)
+{
+  double b;
+  double lk = log(k) / log(2.0);
+
+  if (t == 1 && k >= 2)
+    {
+      /* p(k,1) < k^2 4^(2 - sqrt(k)) */
+      return 2 * lk + 2 * (2 - sqrt(k));
+    }
+  else if (t >= 3 && k >= 21 && t <= k / 9)
+    {
+      /* p(k,t) < k^(3/2) 2^t t^(-1/2) 4^(2 - sqrt(tk)) */
+      return 1.5 * lk + t - 0.5 * log(t) / log(2.0) + 2 * (2 - sqrt(t * k));
+    }
+  else if (k >= 88 && t >= k / 9 && t <= k / 4)
+    {
+      /* p(k,t) < (7/20) k 2^(-5t) + (1/7) k^(15/4) 2^(-k/2 - 2t)
+                  + 12 k 2^(-k/4 - 3t) */
+      b = 0.35 * pow(2.0, lk - 5 * t)
+	+ pow(2.0, 3.75 * lk - k / 2 - 2 * t) / 7
+	+ 12 * pow(2.0, lk - k / 4 - 3 * t);
+      return log(b) / log(2.0);
+    }
+  return 0;
+}
+
+int
+gmpmee_millerrabin_error_reps(unsigned long int bitlen,
+			      unsigned long int error, int random)
+{
+  int t;
+  int worst;
+
+  /* Each round lets a composite pass with probability at most 1/4
+     for any input. */
+  worst = (int)((error + 1) / 2);
+  if (worst < 1)
+    {
+      worst = 1;
+    }
+
+  if (random)
+    {
+      for (t = 1; t < worst; t++)
+	{
+	  if (dlp_log2((double)bitlen, (double)t) <= -(double)error)
+	    {
+	      return t;
+	    }
+	}
+    }
+  return worst;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+#define ROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND(v0, v1, v2, v3)			\
+  do							\
+    {							\
+      v0 += v1; v1 = ROTL(v1, 13); v1 ^= v0;		\
+      v0 = ROTL(v0, 32);				\
+      v2 += v3; v3 = ROTL(v3, 16); v3 ^= v2;		\
+      v0 += v3; v3 = ROTL(v3, 21); v3 ^= v0;		\
+      v2 += v1; v1 = ROTL(v1, 17); v1 ^= v2;		\
+      v2 = ROTL(v2, 32);				\
+    }							\
+  while (0)
+
+/*
+ * Returns the little-endian 64-bit word at the given position.
+ */
+static uint64_t
+load64(const unsigned char *p)
+{
+  int i;
+  uint64_t w = 0;
+
+  for (i = 7; i >= 0; i--)
+    {
+      w = (w << 8) | p[i];
+    }
+  return w;
+}
+
+/*
+ * Stores a 64-bit word in little-endian byte order.
+ */
+static void
+store64(unsigned char *p, uint64_t w)
+{
+  int i;
+
+  for (i = 0; i < 8; i++)
+    {
+      p[i] = (unsigned char)(w >> (8 * i));
+    }
+}
+
+/*
+ * Returns SipHash-2-4 of the data under the 16-byte key.
+ */
+static uint64_t
+siphash(const unsigned char *key, const unsigned char *data, size_t len)
+{
+  size_t i;
+  uint64_t m;
+  uint64_t k0 = load64(key);
+  uint64_t k1 = load64(key + 8);
+  uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+  uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+  uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+  uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+  uint64_t last = (uint64_t)len << 56;
+
+  for (i = 0; i + 8 <= len; i += 8)
+    {
+      m = load64(data + i);
+      v3 ^= m;
+      SIPROUND(v0, v1, v2, v3);
+      SIPROUND(v0, v1, v2, v3);
+      v0 ^= m;
+    }
+  for (; i < len; i++)
+    {
+      last |= (uint64_t)data[i] << (8 * (i & 7));
+    }
+
+  v3 ^= last;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  v0 ^= last;
+
+  v2 ^= 0xff;
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+  SIPROUND(v0, v1, v2, v3);
+
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void
+gmpmee_millerrabin_hash_base(mpz_t base, const unsigned char *seed,
+			     mpz_t n, unsigned long int round)
+{
+  size_t i;
+  size_t len;
+  size_t words;
+  unsigned char *buf;
+  unsigned char nkey[16];
+  unsigned char msg[16];
+  uint64_t *w;
+  mpz_t m;
+
+  /* A key for the integer is derived from the caller's seed and the
+     bytes of the integer, with a trailing domain separator. */
+  len = (mpz_sizeinbase(n, 2) + 7) / 8;
+  buf = (unsigned char *)malloc(len + 1);
+  mpz_export(buf, &len, -1, 1, 0, 0, n);
+  buf[len] = 0;
+  store64(nkey, siphash(seed, buf, len + 1));
+  buf[len] = 1;
+  store64(nkey + 8, siphash(seed, buf, len + 1));
+  free(buf);
+
+  /* The words of the round are the hashes of the round number and a
+     counter. We use 64 more bits than the integer has to make the
+     bias of the reduction negligible. */
+  words = mpz_size(n) * GMP_NUMB_BITS / 64 + 2;
+  w = (uint64_t *)malloc(words * sizeof(uint64_t));
+  store64(msg, round);
+  for (i = 0; i < words; i++)
+    {
+      store64(msg + 8, i);
+      w[i] = siphash(nkey, msg, 16);
+    }
+  mpz_import(base, words, -1, sizeof(uint64_t), 0, 0, w);
+  free(w);
+
+  /* Reduce to an almost uniformly distributed integer in [2,n-2]. */
+  mpz_init(m);
+  mpz_sub_ui(m, n, 3);
+  mpz_mod(base, base, m);
+  mpz_add_ui(base, base, 2);
+  mpz_clear(m);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_hs(const unsigned char *seed, mpz_t n, int reps)
+{
+  int res;
+  gmpmee_millerrabin_state state;
+
+  if (mpz_fits_ulong_p(n))
+    {
+      return gmpmee_millerrabin_ui(mpz_get_ui(n));
+    }
+  else if (gmpmee_millerrabin_trial(n) == 0)
+    {
+      return 0;
+    }
+  else
+    {
+      gmpmee_millerrabin_init(state, n);
+      res = gmpmee_millerrabin_reps_hs(seed, state, 0, reps);
+      gmpmee_millerrabin_clear(state);
+      return res;
+    }
+}
@@ -27,10 +27,7 @@ gmpmee_millerrabin_init(gmpmee_millerrabin_state state, mpz_t n)
   mpz_init(state->n_minus_1);
   mpz_init(state->q);
   mpz_init(state->y);
+  gmpmee_mont_init(state->mont);
 
-  mpz_sub_ui(state->n_minus_1, n, 1L);
-
-  /* Define q and k such that n = q*2^k+1. */
-  state->k = mpz_scan1(state->n_minus_1, 0L);
-  mpz_tdiv_q_2exp(state->q, state->n_minus_1, state->k);
+  gmpmee_millerrabin_update(state);
 }
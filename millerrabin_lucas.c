@@ -0,0 +1,191 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Sets rp to ap - bp modulo the modulus of the context, where the
+ * inputs are reduced.
+ */
+static void
+sub(mp_limb_t *rp, const mp_limb_t *ap, const mp_limb_t *bp,
+    gmpmee_mont mont)
+{
+  if (mpn_sub_n(rp, ap, bp, mont->size))
+    {
+      mpn_add_n(rp, rp, mont->mp, mont->size);
+    }
+}
+
+/*
+ * Sets rp to 2 * ap modulo the modulus of the context, where the
+ * input is reduced.
+ */
+static void
+dbl(mp_limb_t *rp, const mp_limb_t *ap, gmpmee_mont mont)
+{
+  if (mpn_lshift(rp, ap, mont->size, 1)
+      || mpn_cmp(rp, mont->mp, mont->size) >= 0)
+    {
+      mpn_sub_n(rp, rp, mont->mp, mont->size);
+    }
+}
+
+int
+gmpmee_millerrabin_lucas(gmpmee_millerrabin_state state)
+{
+  int j;
+  int res;
+  long int D;
+  long int Q;
+  unsigned long int g;
+  unsigned long int s;
+  unsigned long int i;
+  mp_size_t size;
+  mp_limb_t *v0;
+  mp_limb_t *v1;
+  mp_limb_t *qk;
+  mp_limb_t *qm;
+  mp_limb_t *t;
+  mpz_ptr n = state->n;
+  gmpmee_mont_ptr mont = state->mont;
+  mpz_t d;
+
+  GMPMEE_STATS_INC(lucas);
+
+  /* No D with Jacobi symbol -1 exists for a square. */
+  if (mpz_perfect_square_p(n))
+    {
+      return 0;
+    }
+
+  /* Selfridge's choice of the first D in 5, -7, 9, -11,... with
+     Jacobi symbol (D/n) = -1, and P = 1, Q = (1 - D)/4. A common
+     factor of D and n smaller than n reveals n as composite. */
+  D = 5;
+  for (;;)
+    {
+      j = mpz_si_kronecker(D, n);
+      if (j == -1)
+	{
+	  break;
+	}
+      if (j == 0)
+	{
+	  g = mpz_gcd_ui(NULL, n, labs(D));
+	  if (mpz_cmp_ui(n, g) != 0)
+	    {
+	      return 0;
+	    }
+	}
+      D = D > 0 ? -(D + 2) : -D + 2;
+    }
+  Q = (1 - D) / 4;
+
+  /* Integers small enough to divide Q are tested directly. */
+  g = mpz_gcd_ui(NULL, n, labs(Q));
+  if (g > 1)
+    {
+      return mpz_cmp_ui(n, g) == 0 && gmpmee_millerrabin_ui(g);
+    }
+
+  if (mpz_cmp(mont->modulus, n) != 0)
+    {
+      gmpmee_mont_set(mont, n);
+    }
+  size = mont->size;
+
+  v0 = (mp_limb_t *)malloc(5 * size * sizeof(mp_limb_t));
+  v1 = v0 + size;
+  qk = v1 + size;
+  qm = qk + size;
+  t = qm + size;
+
+  /* V_0 = 2, V_1 = P = 1, Q^0 = 1, and Q in Montgomery
+     representation. */
+  dbl(v0, mont->one, mont);
+  mpn_copyi(v1, mont->one, size);
+  mpn_copyi(qk, mont->one, size);
+  mpz_init_set_si(d, Q);
+  mpz_mod(d, d, n);
+  gmpmee_mont_to(qm, d, mont);
+
+  /* n + 1 = d * 2^s with d odd. */
+  mpz_add_ui(d, n, 1);
+  s = mpz_scan1(d, 0);
+  mpz_tdiv_q_2exp(d, d, s);
+
+  /* Ladder over the bits of d keeping V_k, V_(k+1), and Q^k, where
+     V_(2k) = V_k^2 - 2Q^k, V_(2k+1) = V_k V_(k+1) - PQ^k, and
+     V_(2k+2) = V_(k+1)^2 - 2Q^(k+1). */
+  for (i = mpz_sizeinbase(d, 2); i-- > 0;)
+    {
+      if (mpz_tstbit(d, i))
+	{
+	  if (Q == -1)
+	    {
+	      mpn_sub_n(t, mont->mp, qk, size);
+	    }
+	  else
+	    {
+	      gmpmee_mont_mul(t, qk, qm, mont);
+	    }
+	  gmpmee_mont_mul(v0, v0, v1, mont);
+	  sub(v0, v0, qk, mont);
+	  gmpmee_mont_sqr(v1, v1, mont);
+	  sub(v1, v1, t, mont);
+	  sub(v1, v1, t, mont);
+	  gmpmee_mont_mul(qk, qk, t, mont);
+	}
+      else
+	{
+	  gmpmee_mont_mul(v1, v0, v1, mont);
+	  sub(v1, v1, qk, mont);
+	  gmpmee_mont_sqr(v0, v0, mont);
+	  sub(v0, v0, qk, mont);
+	  sub(v0, v0, qk, mont);
+	  gmpmee_mont_sqr(qk, qk, mont);
+	}
+    }
+
+  /* Since D is invertible modulo n, U_d = (2V_(d+1) - PV_d)/D is zero
+     if and only if 2V_(d+1) = V_d. */
+  dbl(t, v1, mont);
+  res = mpn_cmp(t, v0, size) == 0 || mpn_zero_p(v0, size);
+
+  /* Otherwise V_(d2^r) must be zero for some 0 < r < s. */
+  for (i = 1; !res && i < s; i++)
+    {
+      gmpmee_mont_sqr(v0, v0, mont);
+      sub(v0, v0, qk, mont);
+      sub(v0, v0, qk, mont);
+      res = mpn_zero_p(v0, size);
+      if (i + 1 < s)
+	{
+	  gmpmee_mont_sqr(qk, qk, mont);
+	}
+    }
+
+  mpz_clear(d);
+  free(v0);
+
+  return res;
+}
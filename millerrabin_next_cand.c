@@ -41,8 +41,5 @@ gmpmee_millerrabin_next_cand(gmpmee_millerrabin_state state)
       mpz_add_ui(state->n, state->n, 2L);
     }
 
-  /* Update the state and define q and k such that n = q*2^k+1. */
-  mpz_sub_ui(state->n_minus_1, state->n, 1L);
-  state->k = mpz_scan1(state->n_minus_1, 0L);
-  mpz_tdiv_q_2exp(state->q, state->n_minus_1, state->k);
+  gmpmee_millerrabin_update(state);
 }
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_next_error_rs(mpz_t rop, gmp_randstate_t rstate, mpz_t n,
+				 unsigned long int error, int random)
+{
+  int reps;
+
+  /* Candidates have at least the bit length of n. */
+  reps = gmpmee_millerrabin_error_reps(mpz_sizeinbase(n, 2), error, random);
+  gmpmee_millerrabin_next_rs(rop, rstate, n, reps);
+}
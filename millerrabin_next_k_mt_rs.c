@@ -0,0 +1,311 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Arguments of a single thread testing a chunk of candidates. The
+ * chunk is divided into batches of one candidate for each lane and
+ * the threads test interleaved subsequences of the batches.
+ */
+typedef struct
+{
+  int *results;           /* Destination of results. */
+  mpz_t *cands;           /* Candidates of the chunk. */
+  size_t len;             /* Number of candidates of the chunk. */
+  int reps;               /* Number of repetitions. */
+  unsigned int lanes;     /* Number of lanes of the kernel. */
+  size_t first;           /* Index of first batch of thread. */
+  size_t stride;          /* Distance between batches of thread. */
+  gmp_randstate_t rstate; /* Source of randomness of thread. */
+  gmpmee_stats stats;     /* Counters of thread. */
+} chunk_thread;
+
+/*
+ * Tests the batches of a thread. The first rounds of the candidates
+ * of a batch are executed simultaneously by the multi-lane kernel,
+ * and the remaining rounds only for the candidates that pass. The
+ * candidates have already been sieved, so no trial division is
+ * needed.
+ */
+static void *
+test_batches(void *arg)
+{
+  chunk_thread *thread = (chunk_thread *)arg;
+  size_t b;
+  size_t c;
+  size_t count;
+  unsigned int lanes = thread->lanes;
+  int *results;
+  mpz_ptr n;
+  mpz_t *bases;
+  gmpmee_millerrabin_state *states;
+  gmpmee_millerrabin_state_ptr *ptrs;
+  size_t *indices;
+
+  results = (int *)malloc(lanes * sizeof(int));
+  indices = (size_t *)malloc(lanes * sizeof(size_t));
+  ptrs = (gmpmee_millerrabin_state_ptr *)
+    malloc(lanes * sizeof(gmpmee_millerrabin_state_ptr));
+  bases = gmpmee_array_alloc_init(lanes);
+
+  /* The integer used to initialize the states is irrelevant, since
+     it is replaced by each candidate. */
+  states = (gmpmee_millerrabin_state *)
+    malloc(lanes * sizeof(gmpmee_millerrabin_state));
+  for (c = 0; c < lanes; c++)
+    {
+      gmpmee_millerrabin_init(states[c], thread->cands[0]);
+    }
+
+  for (b = thread->first * lanes; b < thread->len; b += thread->stride * lanes)
+    {
+      /* Integers that fit in a word are tested exactly and the
+	 remaining candidates of the batch are moved into the
+	 states. */
+      count = 0;
+      for (c = b; c < b + lanes && c < thread->len; c++)
+	{
+	  n = thread->cands[c];
+	  if (mpz_fits_ulong_p(n))
+	    {
+	      thread->results[c] = gmpmee_millerrabin_ui(mpz_get_ui(n));
+	      continue;
+	    }
+
+	  ptrs[count] = states[count];
+	  mpz_set(ptrs[count]->n, n);
+	  gmpmee_millerrabin_update(ptrs[count]);
+
+	  /* Almost random base in [2,n-2] */
+	  mpz_urandomm(bases[count], thread->rstate, ptrs[count]->n_minus_1);
+	  if (mpz_cmp_ui(bases[count], 2) < 0)
+	    {
+	      mpz_set_ui(bases[count], 2);
+	    }
+	  indices[count++] = c;
+	}
+
+      if (count > 0)
+	{
+	  gmpmee_millerrabin_once_lanes(results, ptrs, bases, count, lanes);
+	}
+      for (c = 0; c < count; c++)
+	{
+	  thread->results[indices[c]] = results[c]
+	    && gmpmee_millerrabin_reps_rs(thread->rstate, ptrs[c],
+					  thread->reps - 1);
+	}
+    }
+
+  for (c = 0; c < lanes; c++)
+    {
+      gmpmee_millerrabin_clear(states[c]);
+    }
+  free(states);
+  gmpmee_array_clear_dealloc(bases, lanes);
+  free(ptrs);
+  free(indices);
+  free(results);
+
+  gmpmee_stats_get(thread->stats);
+  return NULL;
+}
+
+/*
+ * Tests a chunk of candidates using the given threads.
+ */
+static void
+test_chunk(chunk_thread *threads, unsigned int nthreads, int *results,
+	   mpz_t *cands, size_t len)
+{
+  size_t i;
+  size_t started;
+  pthread_t *ids;
+
+  for (i = 0; i < nthreads; i++)
+    {
+      threads[i].results = results;
+      threads[i].cands = cands;
+      threads[i].len = len;
+    }
+
+  if (nthreads == 1)
+    {
+      test_batches(&threads[0]);
+      return;
+    }
+
+  /* The batches of threads that can not be started are tested by the
+     calling thread. */
+  ids = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+  started = 0;
+  for (i = 1; i < nthreads; i++)
+    {
+      if (pthread_create(&ids[i], NULL, test_batches, &threads[i]) == 0)
+	{
+	  started = i;
+	}
+      else
+	{
+	  break; /* LCOV_EXCL_LINE */
+	}
+    }
+  test_batches(&threads[0]);
+  for (i = started + 1; i < nthreads; i++)
+    {
+      test_batches(&threads[i]); /* LCOV_EXCL_LINE */
+    }
+  for (i = 1; i <= started; i++)
+    {
+      pthread_join(ids[i], NULL);
+      gmpmee_stats_add(threads[i].stats);
+    }
+  free(ids);
+}
+
+void
+gmpmee_millerrabin_next_k_mt_rs(mpz_t *rops, size_t k,
+				gmp_randstate_t rstate, mpz_t n, int reps,
+				unsigned int nthreads)
+{
+  int *results;
+  size_t i;
+  size_t j;
+  size_t chunk;
+  size_t min_chunk;
+  size_t ratio;
+  size_t bitlen;
+  size_t found = 0;
+  size_t tested = 0;
+  unsigned int lanes;
+  mpz_t *cands;
+  chunk_thread *threads;
+  gmpmee_sieve sieve;
+  mpz_t start;
+  mpz_t seed;
+
+  /* The primes two and three are too small for the sieve. */
+  if (found < k && mpz_cmp_ui(n, 2) < 0)
+    {
+      mpz_set_ui(rops[found++], 2);
+    }
+  if (found < k && mpz_cmp_ui(n, 3) < 0)
+    {
+      mpz_set_ui(rops[found++], 3);
+    }
+  if (found == k)
+    {
+      return;
+    }
+
+  /* Sieve the odd integers larger than n and at least five. */
+  mpz_init(start);
+  if (mpz_cmp_ui(n, 5) < 0)
+    {
+      mpz_set_ui(start, 5);
+    }
+  else
+    {
+      mpz_add_ui(start, n, mpz_tstbit(n, 0) ? 2L : 1L);
+    }
+  gmpmee_sieve_init_ui(sieve, start, 2L);
+
+  bitlen = mpz_sizeinbase(start, 2);
+  lanes = gmpmee_lanes_select(bitlen);
+  if (lanes < 1)
+    {
+      lanes = 1;
+    }
+  if (nthreads == 0 || bitlen < GMPMEE_SEARCH_MT_MIN_BITLEN)
+    {
+      nthreads = 1;
+    }
+
+  /* Each thread uses its own source of randomness derived from the
+     given source. */
+  threads = (chunk_thread *)malloc(nthreads * sizeof(chunk_thread));
+  mpz_init(seed);
+  for (i = 0; i < nthreads; i++)
+    {
+      threads[i].reps = reps;
+      threads[i].lanes = lanes;
+      threads[i].first = i;
+      threads[i].stride = nthreads;
+      gmp_randinit_default(threads[i].rstate);
+      mpz_urandomb(seed, rstate, GMPMEE_SEED_BITS);
+      gmp_randseed(threads[i].rstate, seed);
+    }
+  mpz_clear(seed);
+
+  cands = gmpmee_array_alloc_init(GMPMEE_NEXT_K_MAX_CHUNK);
+  results = (int *)malloc(GMPMEE_NEXT_K_MAX_CHUNK * sizeof(int));
+
+  /* Candidates are tested in chunks, in order, until enough primes
+     are found. The size of a chunk is the number of remaining primes
+     times the number of candidates per prime, which is first
+     estimated from the bit length and then from the chunks tested
+     so far, so few candidates beyond the last prime are tested. */
+  ratio = 1 + bitlen / 32;
+  min_chunk = nthreads * lanes;
+  while (found < k)
+    {
+      chunk = (k - found) * ratio;
+      if (chunk < min_chunk)
+	{
+	  chunk = min_chunk;
+	}
+      if (chunk > GMPMEE_NEXT_K_MAX_CHUNK)
+	{
+	  chunk = GMPMEE_NEXT_K_MAX_CHUNK;
+	}
+
+      for (i = 0; i < chunk; i++)
+	{
+	  gmpmee_sieve_next(cands[i], sieve);
+	}
+      test_chunk(threads, nthreads, results, cands, chunk);
+
+      for (i = 0, j = found; i < chunk && found < k; i++)
+	{
+	  if (results[i])
+	    {
+	      mpz_set(rops[found++], cands[i]);
+	    }
+	}
+      tested += chunk;
+      if (found > j)
+	{
+	  ratio = (tested + found - 1) / found;
+	}
+    }
+
+  for (i = 0; i < nthreads; i++)
+    {
+      gmp_randclear(threads[i].rstate);
+    }
+  free(threads);
+  free(results);
+  gmpmee_array_clear_dealloc(cands, GMPMEE_NEXT_K_MAX_CHUNK);
+  gmpmee_sieve_clear(sieve);
+  mpz_clear(start);
+}
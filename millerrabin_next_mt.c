@@ -0,0 +1,52 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_next_mt(mpz_t rop, gmp_randstate_t rstate,
+			   const unsigned char *seed, mpz_t n, int reps,
+			   unsigned int nthreads)
+{
+  gmpmee_sieve sieve;
+  mpz_t start;
+
+  if (mpz_cmp_ui(n, 2) < 0)
+    {
+      mpz_set_ui(rop, 2);
+    }
+  else if (mpz_cmp_ui(n, 3) < 0)
+    {
+      mpz_set_ui(rop, 3);
+    }
+  else
+    {
+      /* Sieve the odd integers larger than n. */
+      mpz_init(start);
+      mpz_add_ui(start, n, mpz_tstbit(n, 0) ? 2L : 1L);
+      gmpmee_sieve_init_ui(sieve, start, 2L);
+
+      gmpmee_millerrabin_search(rop, rstate, seed, sieve, reps, 0,
+				NULL, NULL, nthreads);
+
+      gmpmee_sieve_clear(sieve);
+      mpz_clear(start);
+    }
+}
@@ -23,29 +23,5 @@
 void
 gmpmee_millerrabin_next_rs(mpz_t rop, gmp_randstate_t rstate, mpz_t n, int reps)
 {
-
-  gmpmee_millerrabin_state state;
-
-  if (mpz_cmp_ui(n, 2) < 0)
-    {
-      mpz_set_ui(rop, 2);
-    }
-  else if (mpz_cmp_ui(n, 3) < 0)
-    {
-      mpz_set_ui(rop, 3);
-    }
-  else
-    {
-      gmpmee_millerrabin_init(state, n);
-
-      do
-        {
-          gmpmee_millerrabin_next_cand(state);
-        }
-      while (gmpmee_millerrabin_reps_rs(rstate, state, reps) == 0);
-
-      mpz_set(rop, state->n);
-
-      gmpmee_millerrabin_clear(state);
-    }
+  gmpmee_millerrabin_next_mt_rs(rop, rstate, n, reps, 1);
 }
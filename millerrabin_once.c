@@ -23,7 +23,7 @@
 int
 gmpmee_millerrabin_once(gmpmee_millerrabin_state state, mpz_t base)
 {
-  unsigned long int i;
+  unsigned long int n;
 
   if (mpz_cmp_ui(state->n, 4) < 0) {
     if (mpz_cmp_ui(state->n, 1) > 0) {
@@ -33,27 +33,16 @@ gmpmee_millerrabin_once(gmpmee_millerrabin_state state, mpz_t base)
     }
   }
 
-  mpz_powm(state->y, base, state->q, state->n);
-
-  if (mpz_cmp_ui(state->y, 1L) == 0 || mpz_cmp(state->y, state->n_minus_1) == 0)
+  /* The intermediate value y is not computed for word-sized
+     integers. */
+  if (mpz_odd_p(state->n) && mpz_fits_ulong_p(state->n))
     {
-      return 1;
+      n = mpz_get_ui(state->n);
+      return gmpmee_millerrabin_once_ui(n, mpz_fdiv_ui(base, n));
     }
 
-  for (i = 1; i < state->k; i++)
-    {
-
-      mpz_powm_ui(state->y, state->y, 2L, state->n);
-
-      if (mpz_cmp_ui(state->y, 1L) == 0)
-	{
-	  return 0;
-	}
+  mpz_powm(state->y, base, state->q, state->n);
+  GMPMEE_STATS_INC(powm);
 
-      if (mpz_cmp(state->y, state->n_minus_1) == 0)
-	{
-	  return 1;
-	}
-    }
-  return 0;
+  return gmpmee_millerrabin_once_finish(state);
 }
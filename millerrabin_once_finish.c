@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_once_finish(gmpmee_millerrabin_state state)
+{
+  unsigned long int i;
+  gmpmee_mont_ptr mont;
+  mp_limb_t *yp;
+
+  GMPMEE_STATS_INC(mr_rounds);
+
+  if (mpz_cmp_ui(state->y, 1L) == 0 || mpz_cmp(state->y, state->n_minus_1) == 0)
+    {
+      return 1;
+    }
+
+  /* There are no squarings unless k > 1, in which case n is odd
+     and the context is defined. */
+  if (state->k < 2)
+    {
+      return 0;
+    }
+
+  /* The context is normally kept up to date by the functions that
+     change n, but the state may also have been modified directly. */
+  mont = state->mont;
+  if (mpz_cmp(mont->modulus, state->n) != 0)
+    {
+      gmpmee_mont_set(mont, state->n);
+    }
+
+  /* Square in Montgomery representation to avoid a division in each
+     step. Representations are reduced, so it suffices to compare
+     limbs with the representations of 1 and -1. */
+  yp = mont->xp;
+  gmpmee_mont_to(yp, state->y, mont);
+
+  for (i = 1; i < state->k; i++)
+    {
+
+      gmpmee_mont_sqr(yp, yp, mont);
+
+      if (mpn_cmp(yp, mont->one, mont->size) == 0)
+	{
+	  return 0;
+	}
+
+      if (mpn_cmp(yp, mont->minus_one, mont->size) == 0)
+	{
+	  return 1;
+	}
+    }
+  return 0;
+}
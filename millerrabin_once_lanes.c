@@ -0,0 +1,89 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_once_lanes(int *results,
+			      gmpmee_millerrabin_state_ptr *states,
+			      mpz_t *bases, size_t len, unsigned int lanes)
+{
+  size_t i;
+  size_t j;
+  size_t chunk;
+  size_t *indices;
+  mpz_t *ys;
+  mpz_t *exps;
+  mpz_t *moduli;
+  mpz_t *bs;
+
+  if (lanes < 1)
+    {
+      lanes = 1;
+    }
+
+  indices = (size_t *)malloc(lanes * sizeof(size_t));
+  ys = gmpmee_array_alloc_init(lanes);
+  exps = gmpmee_array_alloc_init(lanes);
+  moduli = gmpmee_array_alloc_init(lanes);
+  bs = gmpmee_array_alloc_init(lanes);
+
+  i = 0;
+  while (i < len)
+    {
+
+      /* Collect states with odd integers greater than three. The
+	 remaining states are tested directly. */
+      chunk = 0;
+      while (i < len && chunk < lanes)
+	{
+	  if (mpz_odd_p(states[i]->n) && mpz_cmp_ui(states[i]->n, 4) > 0)
+	    {
+	      indices[chunk] = i;
+	      mpz_set(bs[chunk], bases[i]);
+	      mpz_set(exps[chunk], states[i]->q);
+	      mpz_set(moduli[chunk], states[i]->n);
+	      chunk++;
+	    }
+	  else
+	    {
+	      results[i] = gmpmee_millerrabin_once(states[i], bases[i]);
+	    }
+	  i++;
+	}
+
+      gmpmee_lanes_powm(ys, bs, exps, moduli, chunk, lanes);
+
+      /* The squarings are completed one state at a time, since a
+	 state may occur several times. */
+      for (j = 0; j < chunk; j++)
+	{
+	  mpz_swap(states[indices[j]]->y, ys[j]);
+	  results[indices[j]] = gmpmee_millerrabin_once_finish(states[indices[j]]);
+	}
+    }
+
+  gmpmee_array_clear_dealloc(bs, lanes);
+  gmpmee_array_clear_dealloc(moduli, lanes);
+  gmpmee_array_clear_dealloc(exps, lanes);
+  gmpmee_array_clear_dealloc(ys, lanes);
+  free(indices);
+}
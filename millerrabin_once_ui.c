@@ -0,0 +1,133 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+#if defined(__SIZEOF_INT128__) && ULONG_MAX == 0xFFFFFFFFFFFFFFFFUL
+
+typedef unsigned __int128 u128;
+
+/*
+ * Montgomery reduction with R = 2^64 of an integer smaller than n*R,
+ * given the inverse of the odd modulus n modulo R. The low words of t
+ * and m*n are equal, so (t - m*n)/R is the difference of the high
+ * words, which is in (-n,n).
+ */
+static unsigned long int
+redc(u128 t, unsigned long int n, unsigned long int ninv)
+{
+  unsigned long int m = (unsigned long int)t * ninv;
+  unsigned long int th = (unsigned long int)(t >> 64);
+  unsigned long int mh = (unsigned long int)(((u128)m * n) >> 64);
+
+  return th < mh ? th - mh + n : th - mh;
+}
+
+int
+gmpmee_millerrabin_once_ui(unsigned long int n, unsigned long int base)
+{
+  int i;
+  int k;
+  unsigned long int q;
+  unsigned long int ninv;
+  unsigned long int one;
+  unsigned long int minus_one;
+  unsigned long int b;
+  unsigned long int y;
+
+  GMPMEE_STATS_INC(mr_rounds);
+
+  /* n - 1 = q * 2^k with q odd. */
+  q = n - 1;
+  k = 0;
+  while ((q & 1) == 0)
+    {
+      q >>= 1;
+      k++;
+    }
+
+  /* Inverse modulo 2^64 by Newton iteration, where each step doubles
+     the number of correct bits starting from three. */
+  ninv = n;
+  for (i = 0; i < 5; i++)
+    {
+      ninv *= 2 - n * ninv;
+    }
+
+  /* Representations of one, minus one, and the base. */
+  one = (unsigned long int)(((u128)1 << 64) % n);
+  minus_one = n - one;
+  b = (unsigned long int)(((u128)(base % n) << 64) % n);
+
+  /* Left-to-right binary exponentiation. */
+  y = b;
+  for (i = 62 - __builtin_clzl(q); i >= 0; i--)
+    {
+      y = redc((u128)y * y, n, ninv);
+      if ((q >> i) & 1)
+	{
+	  y = redc((u128)y * b, n, ninv);
+	}
+    }
+
+  if (y == one || y == minus_one)
+    {
+      return 1;
+    }
+  for (i = 1; i < k; i++)
+    {
+      y = redc((u128)y * y, n, ninv);
+      if (y == minus_one)
+	{
+	  return 1;
+	}
+      if (y == one)
+	{
+	  return 0;
+	}
+    }
+  return 0;
+}
+
+#else
+
+int
+gmpmee_millerrabin_once_ui(unsigned long int n, unsigned long int base)
+{
+  int res;
+  mpz_t nz;
+  mpz_t bz;
+  gmpmee_millerrabin_state state;
+
+  mpz_init_set_ui(nz, n);
+  mpz_init_set_ui(bz, base % n);
+  gmpmee_millerrabin_init(state, nz);
+  mpz_powm(state->y, bz, state->q, state->n);
+  GMPMEE_STATS_INC(powm);
+  res = gmpmee_millerrabin_once_finish(state);
+  gmpmee_millerrabin_clear(state);
+  mpz_clear(bz);
+  mpz_clear(nz);
+
+  return res;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_reps_hs(const unsigned char *seed,
+			   gmpmee_millerrabin_state state,
+			   unsigned long int round, int reps)
+{
+  int i;
+  int j;
+  int res;
+  int chunk;
+  unsigned int lanes;
+  int results[GMPMEE_LANES_IFMA];
+  gmpmee_millerrabin_state_ptr states[GMPMEE_LANES_IFMA];
+  mpz_t *bases;
+  mpz_t base;
+
+  mpz_init(base);
+
+  /* The first round is executed on its own, since almost all
+     composites fail it. */
+  res = 1;
+  i = 0;
+  if (reps > 0)
+    {
+      gmpmee_millerrabin_hash_base(base, seed, state->n, round);
+      res = gmpmee_millerrabin_once(state, base);
+      i++;
+    }
+
+  /* The remaining rounds are executed in groups by a multi-lane
+     kernel if possible. */
+  lanes = gmpmee_lanes_select(mpz_sizeinbase(state->n, 2));
+  if (lanes > 1)
+    {
+      bases = gmpmee_array_alloc_init(lanes);
+      for (j = 0; j < (int)lanes; j++)
+	{
+	  states[j] = state;
+	}
+
+      while (res && i < reps)
+	{
+	  chunk = reps - i < (int)lanes ? reps - i : (int)lanes;
+	  for (j = 0; j < chunk; j++)
+	    {
+	      gmpmee_millerrabin_hash_base(bases[j], seed, state->n,
+					   round + i + j);
+	    }
+	  gmpmee_millerrabin_once_lanes(results, states, bases, chunk, lanes);
+	  for (j = 0; j < chunk; j++)
+	    {
+	      res = res && results[j];
+	    }
+	  i += chunk;
+	}
+
+      gmpmee_array_clear_dealloc(bases, lanes);
+    }
+
+  for (; res && i < reps; i++)
+    {
+      gmpmee_millerrabin_hash_base(base, seed, state->n, round + i);
+      res = gmpmee_millerrabin_once(state, base);
+    }
+
+  mpz_clear(base);
+
+  return res;
+}
@@ -20,13 +20,32 @@
 #include <gmp.h>
 #include "gmpmee.h"
 
+/*
+ * Sets base to an almost random integer in [2,n-2].
+ */
+static void
+random_base(mpz_t base, gmp_randstate_t rstate, mpz_t n_minus_1)
+{
+  mpz_urandomm(base, rstate, n_minus_1);
+  if (mpz_cmp_ui(base, 2) < 0)
+    {
+      mpz_set_ui(base, 2);
+    }
+}
+
 int
 gmpmee_millerrabin_reps_rs(gmp_randstate_t rstate,
 			   gmpmee_millerrabin_state state,
 			   int reps)
 {
   int i;
+  int j;
   int res;
+  int chunk;
+  unsigned int lanes;
+  int results[GMPMEE_LANES_IFMA];
+  gmpmee_millerrabin_state_ptr states[GMPMEE_LANES_IFMA];
+  mpz_t *bases;
   mpz_t base;
   mpz_t n_minus_1;
 
@@ -34,16 +53,48 @@ gmpmee_millerrabin_reps_rs(gmp_randstate_t rstate,
   mpz_init(n_minus_1);
   mpz_sub_ui(n_minus_1, state->n, 1);
 
+  /* The first round is executed on its own, since almost all
+     composites fail it. */
   res = 1;
-  for (i = 0; res && i < reps; i++) {
+  i = 0;
+  if (reps > 0)
+    {
+      random_base(base, rstate, n_minus_1);
+      res = gmpmee_millerrabin_once(state, base);
+      i++;
+    }
+
+  /* The remaining rounds are executed in groups by a multi-lane
+     kernel if possible. */
+  lanes = gmpmee_lanes_select(mpz_sizeinbase(state->n, 2));
+  if (lanes > 1)
+    {
+      bases = gmpmee_array_alloc_init(lanes);
+      for (j = 0; j < (int)lanes; j++)
+	{
+	  states[j] = state;
+	}
+
+      while (res && i < reps)
+	{
+	  chunk = reps - i < (int)lanes ? reps - i : (int)lanes;
+	  for (j = 0; j < chunk; j++)
+	    {
+	      random_base(bases[j], rstate, n_minus_1);
+	    }
+	  gmpmee_millerrabin_once_lanes(results, states, bases, chunk, lanes);
+	  for (j = 0; j < chunk; j++)
+	    {
+	      res = res && results[j];
+	    }
+	  i += chunk;
+	}
 
-    /* Almost random base in [2,n-2] */
-    mpz_urandomm(base, rstate, n_minus_1);
-    if (mpz_cmp_ui(base, 2) < 0)
-      {
-        mpz_set_ui(base, 2);
-      }
+      gmpmee_array_clear_dealloc(bases, lanes);
+    }
 
+  for (; res && i < reps; i++) {
+    random_base(base, rstate, n_minus_1);
     res = gmpmee_millerrabin_once(state, base);
   }
 
@@ -27,9 +27,9 @@ gmpmee_millerrabin_rs(gmp_randstate_t rstate, mpz_t n, int reps)
   int res;
   gmpmee_millerrabin_state state;
 
-  if (mpz_cmp_ui(n, 4) < 0)
+  if (mpz_fits_ulong_p(n))
     {
-      return mpz_tstbit(n, 1);
+      return gmpmee_millerrabin_ui(mpz_get_ui(n));
     }
   else if (gmpmee_millerrabin_trial(n) == 0)
     {
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_safe_bpsw_rs(gmp_randstate_t rstate,
+				gmpmee_millerrabin_safe_state state,
+				int reps)
+{
+  int res;
+  mpz_t two;
+
+  mpz_init_set_ui(two, 2);
+
+  /* FIXME: GCC + libtool is currently broken. See
+     millerrabin_safe_reps_rs.c. */
+
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+
+  /* Almost all candidates fail a strong test of m with base two,
+     where n=2m+1. */
+  res = gmpmee_millerrabin_once(state->mstate, two);
+
+  /* If m is prime, then n is prime if and only if 2^(n-1) = 1 mod n
+     and 3 does not divide n (Pocklington's criterion with the prime
+     factor m of n-1), so only m is tested further. */
+  if (res)
+    {
+      mpz_powm(state->nstate->y, two, state->nstate->n_minus_1,
+	       state->nstate->n);
+      GMPMEE_STATS_INC(powm);
+      res = mpz_cmp_ui(state->nstate->y, 1L) == 0
+	&& !mpz_divisible_ui_p(state->nstate->n, 3L);
+    }
+
+  /* Complete the BPSW test of m and the optional rounds. */
+  if (res)
+    {
+      res = gmpmee_millerrabin_lucas(state->mstate)
+	&& (reps == 0
+	    || gmpmee_millerrabin_reps_rs(rstate, state->mstate, reps));
+    }
+
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+
+  mpz_clear(two);
+
+  return res;
+}
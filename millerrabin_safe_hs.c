@@ -0,0 +1,64 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_safe_hs(const unsigned char *seed, mpz_t n, int reps)
+{
+  int res;
+  unsigned long int u;
+  mpz_t two;
+  gmpmee_millerrabin_safe_state state;
+
+  if (mpz_fits_ulong_p(n))
+    {
+      u = mpz_get_ui(n);
+      return u >= 5 && (u & 1) == 1
+	&& gmpmee_millerrabin_ui(u) && gmpmee_millerrabin_ui(u / 2);
+    }
+  else if (gmpmee_millerrabin_safe_trial(n) == 0)
+    {
+      return 0;
+    }
+  else
+    {
+      gmpmee_millerrabin_safe_init(state, n);
+      mpz_init_set_ui(two, 2);
+
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+
+      /* As in gmpmee_millerrabin_safe_reps_rs the test of m with base
+	 two comes first. */
+      res = gmpmee_millerrabin_once(state->mstate, two)
+	&& gmpmee_millerrabin_safe_pocklington_hs(seed, state, reps);
+
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+
+      mpz_clear(two);
+      gmpmee_millerrabin_safe_clear(state);
+      return res;
+    }
+}
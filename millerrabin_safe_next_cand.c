@@ -51,16 +51,10 @@ gmpmee_millerrabin_safe_next_cand(gmpmee_millerrabin_safe_state state)
       mpz_add_ui(state->nstate->n, state->nstate->n, 4L);
     }
 
-  /* Update the state for testing of n, and define q and k such that
-     n=q*2^k+1. (q and k are local to the state) */
-  mpz_sub_ui(state->nstate->n_minus_1, state->nstate->n, 1L);
-  state->nstate->k = mpz_scan1(state->nstate->n_minus_1, 0L);
-  mpz_tdiv_q_2exp(state->nstate->q, state->nstate->n_minus_1, state->nstate->k);
+  /* Update the state for testing of n. */
+  gmpmee_millerrabin_update(state->nstate);
 
-  /* Update the state for testing of m, where n=2m+1, and define q and
-     k such that m=q*2^k+1. (q and k are local to the state) */
+  /* Update the state for testing of m, where n=2m+1. */
   mpz_div_ui(state->mstate->n, state->nstate->n_minus_1, 2);
-  mpz_sub_ui(state->mstate->n_minus_1, state->mstate->n, 1L);
-  state->mstate->k = mpz_scan1(state->mstate->n_minus_1, 0L);
-  mpz_tdiv_q_2exp(state->mstate->q, state->mstate->n_minus_1, state->mstate->k);
+  gmpmee_millerrabin_update(state->mstate);
 }
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_safe_next_mt(mpz_t rop, gmp_randstate_t rstate,
+				const unsigned char *seed, mpz_t n, int reps,
+				unsigned int nthreads)
+{
+  int increased = 0;
+  gmpmee_sieve sieve;
+  mpz_t start;
+
+  if (mpz_cmp_ui(n, 5) < 0)
+    {
+      mpz_set_ui(rop, 5);
+    }
+  else if (mpz_cmp_ui(n, 7) < 0)
+    {
+      mpz_set_ui(rop, 7);
+    }
+  else
+    {
+      mpz_init_set(start, n);
+
+      /* Make sure that start is odd. */
+      if (!mpz_tstbit(start, 0))
+        {
+          mpz_add_ui(start, start, 1L);
+          increased = 1;
+        }
+
+      /* Make sure that m is odd, where start=2m+1. */
+      if (!mpz_tstbit(start, 1))
+        {
+          mpz_add_ui(start, start, 2L);
+          increased = 1;
+        }
+
+      /* If both start and m were already odd, then we add 4. */
+      if (!increased)
+        {
+          mpz_add_ui(start, start, 4L);
+        }
+
+      /* Sieve the integers larger than n that are congruent to 3
+         modulo 4. */
+      gmpmee_sieve_safe_init_ui(sieve, start, 4L);
+
+      gmpmee_millerrabin_search(rop, rstate, seed, sieve, reps, 0,
+				NULL, NULL, nthreads);
+
+      gmpmee_sieve_clear(sieve);
+      mpz_clear(start);
+    }
+}
@@ -24,29 +24,5 @@ void
 gmpmee_millerrabin_safe_next_rs(mpz_t rop, gmp_randstate_t rstate,
 				mpz_t n, int reps)
 {
-  gmpmee_millerrabin_safe_state state;
-
-  if (mpz_cmp_ui(n, 5) < 0)
-    {
-      mpz_set_ui(rop, 5);
-    }
-  else if (mpz_cmp_ui(n, 7) < 0)
-    {
-      mpz_set_ui(rop, 7);
-    }
-  else
-    {
-
-      gmpmee_millerrabin_safe_init(state, n);
-
-      do
-        {
-          gmpmee_millerrabin_safe_next_cand(state);
-        }
-      while (gmpmee_millerrabin_safe_reps_rs(rstate, state, reps) == 0);
-
-      mpz_set(rop, state->nstate->n);
-
-      gmpmee_millerrabin_safe_clear(state);
-    }
+  gmpmee_millerrabin_safe_next_mt_rs(rop, rstate, n, reps, 1);
 }
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_millerrabin_safe_pocklington_hs(const unsigned char *seed,
+				       gmpmee_millerrabin_safe_state state,
+				       int reps)
+{
+  int res;
+  mpz_t two;
+
+  mpz_init_set_ui(two, 2);
+
+  /* FIXME: GCC + libtool is currently broken. See
+     millerrabin_safe_reps_rs.c. */
+
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+
+  /* Pocklington's criterion for n given that m is prime, see
+     millerrabin_safe_pocklington_rs.c. */
+  mpz_powm(state->nstate->y, two, state->nstate->n_minus_1,
+	   state->nstate->n);
+  GMPMEE_STATS_INC(powm);
+  res = mpz_cmp_ui(state->nstate->y, 1L) == 0
+    && !mpz_divisible_ui_p(state->nstate->n, 3L);
+
+  if (res)
+    {
+      res = gmpmee_millerrabin_reps_hs(seed, state->mstate, 0, reps + 1);
+    }
+
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+
+  mpz_clear(two);
+
+  return res;
+}
@@ -25,79 +25,41 @@ gmpmee_millerrabin_safe_reps_rs(gmp_randstate_t rstate,
 				gmpmee_millerrabin_safe_state state,
 				int reps)
 {
-  int i;
-  int res = 1;
-  mpz_t nn_minus_1;
-  mpz_t nbase;
-  mpz_t mn_minus_1;
-  mpz_t mbase;
+  int res;
+  mpz_t two;
 
-  mpz_init(nn_minus_1);
-  mpz_sub_ui(nn_minus_1, state->nstate->n, 1);
-  mpz_init(nbase);
+  mpz_init_set_ui(two, 2);
 
-  mpz_init(mn_minus_1);
-  mpz_sub_ui(mn_minus_1, state->mstate->n, 1);
-  mpz_init(mbase);
-
-  /* Repeat an additional time. The union bound then gives the
-     expected provable error probability. */
-  for (i = 0; i < reps + 1; i++) {
-
-    /* Random base in [2,n-2] */
-    mpz_urandomm(nbase, rstate, nn_minus_1);
-    if (mpz_cmp_ui(nbase, 2) < 0)
-      {
-        mpz_set_ui(nbase, 2);
-      }
-
-    /* FIXME: GCC + libtool is currently broken. A fixed-size array
-       within a struct is valid C code and sizeof() should determine
-       the correct size of the resulting struct, including any
-       padding, but without disabling this libtool gives a warning. It
-       would still be better to rewrite the code to avoid the buggy
-       error. This is however quite difficult to do in a backwards
-       compatible way. */
+  /* FIXME: GCC + libtool is currently broken. A fixed-size array
+     within a struct is valid C code and sizeof() should determine
+     the correct size of the resulting struct, including any
+     padding, but without disabling this libtool gives a warning. It
+     would still be better to rewrite the code to avoid the buggy
+     error. This is however quite difficult to do in a backwards
+     compatible way. */
 
 #ifndef __clang__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
-#endif
-    if (gmpmee_millerrabin_once(state->nstate, nbase) == 0)
-      {
-	res = 0;
-	break;
-      }
-#ifndef __clang__
-#pragma GCC diagnostic pop
 #endif
 
-    /* Random base in [2,m-2] */
-    mpz_urandomm(mbase, rstate, mn_minus_1);
-    if (mpz_cmp_ui(mbase, 2) < 0)
-      {
-        mpz_set_ui(mbase, 2);
-      }
+  /* Almost all candidates that survive trial division or sieving
+     are composite and fail a single strong test with base two, so we
+     start with such a test of m, where n=2m+1. */
+  res = gmpmee_millerrabin_once(state->mstate, two);
+
+  /* The remaining tests are only executed for the few candidates
+     that pass. */
+  if (res)
+    {
+      res = gmpmee_millerrabin_safe_pocklington_rs(rstate, state, reps);
+    }
 
-#ifndef __clang__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wstringop-overflow"
-#endif
-    if (gmpmee_millerrabin_once(state->mstate, mbase) == 0)
-      {
-	res = 0;
-	break;
-      }
 #ifndef __clang__
 #pragma GCC diagnostic pop
 #endif
-  }
-
-  mpz_clear(nn_minus_1);
-  mpz_clear(nbase);
 
-  mpz_clear(mn_minus_1);
-  mpz_clear(mbase);
+  mpz_clear(two);
 
   return res;
 }
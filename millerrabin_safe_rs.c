@@ -25,18 +25,14 @@ gmpmee_millerrabin_safe_rs(gmp_randstate_t rstate, mpz_t n, int reps)
 {
 
   int res;
+  unsigned long int u;
   gmpmee_millerrabin_safe_state state;
 
-  if (mpz_cmp_ui(n, 8) < 0)
+  if (mpz_fits_ulong_p(n))
     {
-      if (mpz_cmp_ui(n, 5) == 0 || mpz_cmp_ui(n, 7) == 0)
-        {
-          return 1;
-        }
-      else
-        {
-          return 0;
-        }
+      u = mpz_get_ui(n);
+      return u >= 5 && (u & 1) == 1
+	&& gmpmee_millerrabin_ui(u) && gmpmee_millerrabin_ui(u / 2);
     }
   else if (gmpmee_millerrabin_safe_trial(n) == 0)
     {
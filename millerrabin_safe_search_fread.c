@@ -0,0 +1,85 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Version of the format read by this function.
+ */
+#define FORMAT_VERSION 1
+
+int
+gmpmee_millerrabin_safe_search_fread(gmpmee_millerrabin_safe_search search,
+				     FILE *stream, int reps)
+{
+  int version;
+  int res;
+
+  mpz_init(search->next);
+  mpz_init(search->end);
+  mpz_init(search->result);
+
+  res = fscanf(stream, "gmpmee_safe_search %d", &version) == 1
+    && version == FORMAT_VERSION
+    && fscanf(stream, "%d %d %d", &search->reps, &search->found,
+	      &search->exhausted) == 3
+    && gmp_fscanf(stream, "%Zx %Zx %Zx", search->next, search->end,
+		  search->result) == 3
+    && fscanf(stream, "%lu %lu %lf %zu", &search->sieved, &search->tested,
+	      &search->seconds, &search->chunk) == 4;
+
+  /* The position must be a valid starting point of the sieve. */
+  res = res
+    && search->reps == reps
+    && mpz_cmp_ui(search->next, 11) >= 0
+    && mpz_fdiv_ui(search->next, 4) == 3
+    && search->chunk >= GMPMEE_SAFE_SEARCH_MIN_CHUNK
+    && search->chunk <= GMPMEE_SAFE_SEARCH_MAX_CHUNK;
+
+  /* A found safe prime precedes the position and lies in the range,
+     and a search is only exhausted if the position is beyond the
+     end of the range. */
+  res = res
+    && (search->found == 0 || search->found == 1)
+    && (search->exhausted == 0 || search->exhausted == 1)
+    && !(search->found && search->exhausted)
+    && (!search->found
+	|| (mpz_cmp_ui(search->result, 5) >= 0
+	    && mpz_cmp(search->result, search->next) < 0
+	    && (mpz_sgn(search->end) == 0
+		|| mpz_cmp(search->result, search->end) < 0)))
+    && (!search->exhausted
+	|| (mpz_sgn(search->end) != 0
+	    && mpz_cmp(search->next, search->end) >= 0));
+
+  if (res)
+    {
+      search->rate = 0;
+      search->sieve_ready = 0;
+    }
+  else
+    {
+      mpz_clear(search->result);
+      mpz_clear(search->end);
+      mpz_clear(search->next);
+    }
+  return res;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Version of the format written by this function.
+ */
+#define FORMAT_VERSION 1
+
+int
+gmpmee_millerrabin_safe_search_fwrite(FILE *stream,
+				      gmpmee_millerrabin_safe_search search)
+{
+  /* Integers are written in hexadecimal and the remaining fields in
+     decimal, so the format does not depend on the platform. */
+  return gmp_fprintf(stream,
+		     "gmpmee_safe_search %d\n"
+		     "%d %d %d\n"
+		     "%Zx\n%Zx\n%Zx\n"
+		     "%lu %lu %.3f %zu\n",
+		     FORMAT_VERSION,
+		     search->reps, search->found, search->exhausted,
+		     search->next, search->end, search->result,
+		     search->sieved, search->tested, search->seconds,
+		     search->chunk) > 0
+    && fflush(stream) == 0;
+}
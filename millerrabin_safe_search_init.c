@@ -0,0 +1,56 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_safe_search_init(gmpmee_millerrabin_safe_search search,
+				    mpz_t start, mpz_t end, int reps)
+{
+  mpz_init(search->next);
+  mpz_init_set(search->end, end);
+  mpz_init(search->result);
+  search->reps = reps;
+  search->found = 0;
+  search->exhausted = 0;
+  search->sieved = 0;
+  search->tested = 0;
+  search->seconds = 0;
+  search->rate = 0;
+  search->chunk = GMPMEE_SAFE_SEARCH_MIN_CHUNK;
+  search->sieve_ready = 0;
+
+  /* The safe primes 5 and 7 are too small for the sieve and the
+     test, and every larger safe prime is congruent to 3 modulo 4. */
+  if (mpz_cmp_ui(start, 7) <= 0)
+    {
+      mpz_set_ui(search->result, mpz_cmp_ui(start, 5) <= 0 ? 5L : 7L);
+      mpz_set_ui(search->next, 11);
+      search->found = mpz_sgn(end) == 0 || mpz_cmp(search->result, end) < 0;
+      search->exhausted = !search->found;
+    }
+  else
+    {
+      mpz_set(search->next, start);
+      mpz_add_ui(search->next, search->next,
+		 (3 - mpz_fdiv_ui(search->next, 4)) & 3);
+      search->exhausted = mpz_sgn(end) != 0 && mpz_cmp(search->next, end) >= 0;
+    }
+}
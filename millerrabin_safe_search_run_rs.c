@@ -0,0 +1,148 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <time.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns the time in seconds of a monotonic clock.
+ */
+static double
+now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int
+gmpmee_millerrabin_safe_search_run_rs(gmpmee_millerrabin_safe_search search,
+				      gmp_randstate_t rstate,
+				      unsigned long int max_cands,
+				      unsigned long int max_ms,
+				      unsigned int nthreads,
+				      gmpmee_millerrabin_safe_search_progress
+				      progress, void *arg)
+{
+  int found;
+  size_t chunk;
+  size_t count;
+  unsigned long int cands = 0;
+  double start_time = now();
+  double chunk_time;
+  double elapsed;
+  gmpmee_sieve_ptr sieve = search->sieve;
+  mpz_t start;
+
+  if (search->found || search->exhausted)
+    {
+      return 1;
+    }
+
+  if (!search->sieve_ready)
+    {
+      gmpmee_sieve_safe_init_ui(sieve, search->next, 4L);
+      search->sieve_ready = 1;
+    }
+
+  mpz_init(start);
+
+  for (;;)
+    {
+      chunk = search->chunk;
+      if (max_cands != 0 && max_cands - cands < chunk)
+	{
+	  chunk = max_cands - cands;
+	}
+
+      /* Every candidate handed out by the sieve is tested unless a
+	 safe prime is found or the end of the range is reached, so the
+	 position of the sieve after the part is the position of the
+	 search. */
+      mpz_set(start, search->next);
+      chunk_time = now();
+      found = gmpmee_millerrabin_search(search->result, rstate, NULL, sieve,
+					search->reps, chunk,
+					mpz_sgn(search->end) == 0
+					? NULL : search->end,
+					&count, nthreads);
+      chunk_time = now() - chunk_time;
+
+      if (found)
+	{
+	  mpz_add_ui(search->next, search->result, 4);
+	  search->found = 1;
+	}
+      else
+	{
+	  mpz_set(search->next, sieve->base);
+	  mpz_addmul_ui(search->next, sieve->step, sieve->index);
+	  search->exhausted = mpz_sgn(search->end) != 0
+	    && mpz_cmp(search->next, search->end) >= 0;
+	}
+
+      mpz_sub(start, search->next, start);
+      mpz_fdiv_q_2exp(start, start, 2);
+      search->sieved += mpz_get_ui(start);
+      search->tested += count;
+      search->seconds += chunk_time;
+      search->rate = chunk_time > 0 ? count / chunk_time : 0;
+      cands += count;
+
+      /* The number of candidates of each part is adapted to keep the
+	 interval between calls of the callback close to the target. */
+      if (chunk == search->chunk)
+	{
+	  if (chunk_time < GMPMEE_SAFE_SEARCH_INTERVAL / 2
+	      && search->chunk < GMPMEE_SAFE_SEARCH_MAX_CHUNK)
+	    {
+	      search->chunk *= 2;
+	    }
+	  else if (chunk_time > 2 * GMPMEE_SAFE_SEARCH_INTERVAL
+		   && search->chunk > GMPMEE_SAFE_SEARCH_MIN_CHUNK)
+	    {
+	      search->chunk /= 2;
+	    }
+	}
+
+      if (progress != NULL)
+	{
+	  progress(search, arg);
+	}
+
+      elapsed = now() - start_time;
+      if (search->found || search->exhausted
+	  || (max_cands != 0 && cands >= max_cands)
+	  || (max_ms != 0 && elapsed * 1000 >= max_ms))
+	{
+	  break;
+	}
+    }
+
+  if (search->found || search->exhausted)
+    {
+      gmpmee_sieve_clear(sieve);
+      search->sieve_ready = 0;
+    }
+  mpz_clear(start);
+
+  return search->found || search->exhausted;
+}
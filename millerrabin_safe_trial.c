@@ -23,29 +23,14 @@
 int
 gmpmee_millerrabin_safe_trial(mpz_t n)
 {
-  mp_limb_t r;
-  int res = 1;
-
-  mpz_t m;
-
   /* Odd or smaller than 5. */
   if (mpz_tstbit(n, 0) == 0 || mpz_cmp_ui(n, 5) < 0)
     {
-      res = 0;
+      return 0;
     }
   else
     {
-
-      mpz_init(m);
-      mpz_tdiv_q_2exp (m, n, 1); /* m = (n-1)/2 */
-
-#if __SIZEOF_INT__ == 4
-#include "trialdiv_safe_32.c"
-#elif __SIZEOF_INT__ == 8
-#include "trialdiv_safe_64.c"
-#endif
-
-      mpz_clear(m);
+      /* Divisibility of m = (n-1)/2 is read off the remainders of n. */
+      return gmpmee_trial(n, 1);
     }
-  return res;
 }
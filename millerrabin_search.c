@@ -0,0 +1,409 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * State shared by the threads of a search. Each candidate output by
+ * the sieve is given a sequence number when it is handed out, and
+ * the search stops handing out candidates when a candidate with a
+ * smaller sequence number has been found to be a (safe) prime, or
+ * when a candidate is not smaller than the upper bound.
+ */
+typedef struct
+{
+  pthread_mutex_t lock;    /* Protects all fields below. */
+  gmpmee_sieve_ptr sieve;  /* Source of candidates. */
+  const unsigned char *seed; /* Seed of hash-derived bases, or NULL. */
+  int reps;                /* Number of repetitions. */
+  size_t max_cands;        /* Bound on candidates, or zero. */
+  mpz_ptr end;             /* Bound on (safe) primes, or NULL. */
+  int ended;               /* Indicates that end was reached. */
+  size_t issued;           /* Number of candidates handed out. */
+  int found;               /* Indicates if best is defined. */
+  size_t best_seq;         /* Sequence number of best. */
+  mpz_t best;              /* Smallest (safe) prime found. */
+} search_shared;
+
+/*
+ * Arguments of a single thread of a search.
+ */
+typedef struct
+{
+  search_shared *shared;
+  gmp_randstate_t rstate;
+  gmpmee_stats stats;
+} search_thread;
+
+/*
+ * Hands out the next candidate unless the search is done. Returns
+ * 1 and the sequence number of the candidate if a candidate is
+ * handed out and 0 otherwise. The lock must be held by the caller.
+ */
+static int
+next_cand(search_shared *shared, gmpmee_millerrabin_state state,
+	  gmpmee_millerrabin_safe_state safe_state, size_t *seq)
+{
+  mpz_ptr n;
+
+  if (shared->ended
+      || (shared->found && shared->issued >= shared->best_seq)
+      || (shared->max_cands != 0 && shared->issued >= shared->max_cands))
+    {
+      return 0;
+    }
+
+  if (shared->sieve->safe)
+    {
+      gmpmee_millerrabin_safe_next_cand_sieve(safe_state, shared->sieve);
+      n = safe_state->nstate->n;
+    }
+  else
+    {
+      gmpmee_millerrabin_next_cand_sieve(state, shared->sieve);
+      n = state->n;
+    }
+
+  /* Candidates are output in increasing order, so no candidate is
+     handed out after the first one outside the range. */
+  if (shared->end != NULL && mpz_cmp(n, shared->end) >= 0)
+    {
+      shared->ended = 1;
+      return 0;
+    }
+  *seq = shared->issued++;
+  return 1;
+}
+
+/*
+ * Executes the first round of the test for each candidate of a batch
+ * using the multi-lane kernel with the given number of lanes, if
+ * any. For safe primes this is the test of m with base two, where
+ * n=2m+1.
+ */
+static void
+first_round(int *results, gmp_randstate_t rstate,
+	    const unsigned char *seed, int safe,
+	    gmpmee_millerrabin_state *states,
+	    gmpmee_millerrabin_safe_state *safe_states,
+	    gmpmee_millerrabin_state_ptr *ptrs, mpz_t *bases, size_t count,
+	    unsigned int lanes)
+{
+  size_t c;
+  mpz_ptr n;
+
+  for (c = 0; c < count; c++)
+    {
+      if (safe)
+	{
+	  ptrs[c] = safe_states[c]->mstate;
+	  mpz_set_ui(bases[c], 2);
+	}
+      else
+	{
+	  ptrs[c] = states[c];
+
+	  if (seed != NULL)
+	    {
+	      gmpmee_millerrabin_hash_base(bases[c], seed, states[c]->n, 0);
+	    }
+	  else
+	    {
+	      /* Almost random base in [2,n-2] */
+	      n = states[c]->n_minus_1;
+	      mpz_urandomm(bases[c], rstate, n);
+	      if (mpz_cmp_ui(bases[c], 2) < 0)
+		{
+		  mpz_set_ui(bases[c], 2);
+		}
+	    }
+	}
+    }
+
+  gmpmee_millerrabin_once_lanes(results, ptrs, bases, count, lanes);
+}
+
+static void
+search(search_shared *shared, gmp_randstate_t rstate)
+{
+  int res;
+  size_t c;
+  size_t count;
+  size_t batch;
+  unsigned int lanes;
+  int safe = shared->sieve->safe;
+  int *results;
+  size_t *seqs;
+  mpz_ptr n;
+  mpz_t *bases;
+  gmpmee_millerrabin_state *states = NULL;
+  gmpmee_millerrabin_safe_state *safe_states = NULL;
+  gmpmee_millerrabin_state_ptr *ptrs;
+
+  /* With a multi-lane kernel the first rounds of a batch of
+     candidates, one for each lane, are executed simultaneously. */
+  lanes = gmpmee_lanes_select(mpz_sizeinbase(shared->sieve->base, 2));
+  batch = lanes > 1 ? lanes : 1;
+
+  results = (int *)malloc(batch * sizeof(int));
+  seqs = (size_t *)malloc(batch * sizeof(size_t));
+  ptrs = (gmpmee_millerrabin_state_ptr *)
+    malloc(batch * sizeof(gmpmee_millerrabin_state_ptr));
+  bases = gmpmee_array_alloc_init(batch);
+
+  /* The integer used to initialize the states is irrelevant, since
+     it is replaced by each candidate. */
+  if (safe)
+    {
+      safe_states = (gmpmee_millerrabin_safe_state *)
+	malloc(batch * sizeof(gmpmee_millerrabin_safe_state));
+      for (c = 0; c < batch; c++)
+	{
+	  gmpmee_millerrabin_safe_init(safe_states[c], shared->sieve->step);
+	}
+    }
+  else
+    {
+      states = (gmpmee_millerrabin_state *)
+	malloc(batch * sizeof(gmpmee_millerrabin_state));
+      for (c = 0; c < batch; c++)
+	{
+	  gmpmee_millerrabin_init(states[c], shared->sieve->step);
+	}
+    }
+
+  for (;;)
+    {
+      pthread_mutex_lock(&shared->lock);
+      count = 0;
+      while (count < batch
+	     && next_cand(shared, safe ? NULL : states[count],
+			  safe ? safe_states[count] : NULL, &seqs[count]))
+	{
+	  count++;
+	}
+      pthread_mutex_unlock(&shared->lock);
+
+      if (count == 0)
+	{
+	  break;
+	}
+
+      /* Without repetitions the first round is skipped, except for
+	 safe primes, where it is part of the test. */
+      if (safe || shared->reps > 0)
+	{
+	  first_round(results, rstate, shared->seed, safe, states,
+		      safe_states, ptrs, bases, count, lanes);
+	}
+      else
+	{
+	  for (c = 0; c < count; c++)
+	    {
+	      results[c] = 1;
+	    }
+	}
+
+      /* Complete the tests of the candidates that passed the first
+	 round in order, until one passes. */
+      for (c = 0; c < count; c++)
+	{
+	  if (!results[c])
+	    {
+	      continue;
+	    }
+
+	  if (safe)
+	    {
+	      res = shared->seed != NULL
+		? gmpmee_millerrabin_safe_pocklington_hs(shared->seed,
+							 safe_states[c],
+							 shared->reps)
+		: gmpmee_millerrabin_safe_pocklington_rs(rstate,
+							 safe_states[c],
+							 shared->reps);
+	      n = safe_states[c]->nstate->n;
+	    }
+	  else
+	    {
+	      res = shared->seed != NULL
+		? gmpmee_millerrabin_reps_hs(shared->seed, states[c], 1,
+					     shared->reps - 1)
+		: gmpmee_millerrabin_reps_rs(rstate, states[c],
+					     shared->reps - 1);
+	      n = states[c]->n;
+	    }
+
+	  if (res)
+	    {
+	      pthread_mutex_lock(&shared->lock);
+	      if (!shared->found || seqs[c] < shared->best_seq)
+		{
+		  shared->found = 1;
+		  shared->best_seq = seqs[c];
+		  mpz_set(shared->best, n);
+		}
+	      pthread_mutex_unlock(&shared->lock);
+	      break;
+	    }
+	}
+    }
+
+  if (safe)
+    {
+      for (c = 0; c < batch; c++)
+	{
+	  gmpmee_millerrabin_safe_clear(safe_states[c]);
+	}
+      free(safe_states);
+    }
+  else
+    {
+      for (c = 0; c < batch; c++)
+	{
+	  gmpmee_millerrabin_clear(states[c]);
+	}
+      free(states);
+    }
+
+  gmpmee_array_clear_dealloc(bases, batch);
+  free(ptrs);
+  free(seqs);
+  free(results);
+}
+
+static void *
+search_thread_main(void *arg)
+{
+  search_thread *thread = (search_thread *)arg;
+
+  search(thread->shared, thread->rstate);
+  gmpmee_stats_get(thread->stats);
+  return NULL;
+}
+
+int
+gmpmee_millerrabin_search(mpz_t rop, gmp_randstate_t rstate,
+			  const unsigned char *seed, gmpmee_sieve sieve,
+			  int reps, size_t max_cands, mpz_t end,
+			  size_t *tested, unsigned int nthreads)
+{
+  unsigned int i;
+  unsigned int started;
+  int res;
+  mpz_t rseed;
+  search_shared shared;
+  search_thread *threads;
+  pthread_t *ids;
+
+  pthread_mutex_init(&shared.lock, NULL);
+  shared.sieve = sieve;
+  shared.seed = seed;
+  shared.reps = reps;
+  shared.max_cands = max_cands;
+  shared.end = end;
+  shared.ended = 0;
+  shared.issued = 0;
+  shared.found = 0;
+  shared.best_seq = 0;
+  mpz_init(shared.best);
+
+  /* Seeding a source of randomness for each thread costs more than
+     the complete search for small integers. */
+  if (nthreads <= 1
+      || mpz_sizeinbase(sieve->base, 2) < GMPMEE_SEARCH_MT_MIN_BITLEN)
+    {
+      search(&shared, rstate);
+    }
+  else
+    {
+      threads = (search_thread *)malloc(nthreads * sizeof(search_thread));
+      ids = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+
+      /* Each thread uses its own source of randomness derived from
+	 the given source, unless the bases are derived from a seed
+	 without any mutable state, in which case the sources of the
+	 threads are never initialized or used. */
+      mpz_init(rseed);
+      for (i = 0; i < nthreads; i++)
+	{
+	  threads[i].shared = &shared;
+	  if (seed == NULL)
+	    {
+	      gmp_randinit_default(threads[i].rstate);
+	      mpz_urandomb(rseed, rstate, GMPMEE_SEED_BITS);
+	      gmp_randseed(threads[i].rstate, rseed);
+	    }
+	}
+      mpz_clear(rseed);
+
+      /* If a thread can not be started, then the remaining work is
+	 simply done by the threads that were started. */
+      started = 0;
+      for (i = 1; i < nthreads; i++)
+	{
+	  if (pthread_create(&ids[i], NULL, search_thread_main,
+			     &threads[i]) == 0)
+	    {
+	      started = i;
+	    }
+	  else
+	    {
+	      break; /* LCOV_EXCL_LINE */
+	    }
+	}
+      search(&shared, threads[0].rstate);
+      for (i = 1; i <= started; i++)
+	{
+	  pthread_join(ids[i], NULL);
+	  gmpmee_stats_add(threads[i].stats);
+	}
+
+      if (seed == NULL)
+	{
+	  for (i = 0; i < nthreads; i++)
+	    {
+	      gmp_randclear(threads[i].rstate);
+	    }
+	}
+      free(ids);
+      free(threads);
+    }
+
+  res = shared.found;
+  if (res)
+    {
+      mpz_set(rop, shared.best);
+    }
+
+  /* Candidates handed out after the (safe) prime do not count, since
+     they are handed out again if the search is continued. */
+  if (tested != NULL)
+    {
+      *tested = res ? shared.best_seq + 1 : shared.issued;
+    }
+
+  mpz_clear(shared.best);
+  pthread_mutex_destroy(&shared.lock);
+
+  return res;
+}
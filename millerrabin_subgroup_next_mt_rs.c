@@ -0,0 +1,76 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_millerrabin_subgroup_next_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+				       mpz_t n, mpz_t q, int reps,
+				       unsigned int nthreads)
+{
+  gmpmee_sieve sieve;
+  mpz_t k;
+  mpz_t start;
+  mpz_t step;
+
+  /* The only even prime 2 = kq + 1 is skipped by the sieve below. */
+  if (mpz_cmp_ui(q, 1) == 0 && mpz_cmp_ui(n, 2) < 0)
+    {
+      mpz_set_ui(rop, 2);
+      return;
+    }
+
+  mpz_init(k);
+  mpz_init(start);
+  mpz_init(step);
+
+  /* Smallest k such that kq + 1 > n. If q is odd, then kq + 1 is
+     only odd for even k. */
+  mpz_cdiv_q(k, n, q);
+  if (mpz_cmp_ui(k, 1) < 0)
+    {
+      mpz_set_ui(k, 1);
+    }
+  if (mpz_odd_p(q))
+    {
+      if (mpz_odd_p(k))
+	{
+	  mpz_add_ui(k, k, 1);
+	}
+      mpz_mul_2exp(step, q, 1);
+    }
+  else
+    {
+      mpz_set(step, q);
+    }
+
+  /* Sieve the integers kq + 1. The residues of the step modulo the
+     sieving primes are computed once by the sieve. */
+  mpz_mul(start, k, q);
+  mpz_add_ui(start, start, 1);
+  gmpmee_sieve_init(sieve, start, step);
+
+  gmpmee_millerrabin_search_rs(rop, rstate, sieve, reps, 0, nthreads);
+
+  gmpmee_sieve_clear(sieve);
+  mpz_clear(step);
+  mpz_clear(start);
+  mpz_clear(k);
+}
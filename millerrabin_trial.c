@@ -23,24 +23,13 @@
 int
 gmpmee_millerrabin_trial(mpz_t n)
 {
-  mp_limb_t r;
-  int res = 1;
-
   /* Check parity. */
   if (mpz_tstbit(n, 0) == 0)
     {
-      res = 0;
+      return 0;
     }
   else
     {
-
-#if __SIZEOF_INT__ == 4
-#include "trialdiv_32.c"
-#elif __SIZEOF_INT__ == 8
-#include "trialdiv_64.c"
-#endif
-
+      return gmpmee_trial(n, 0);
     }
-
-  return res;
 }
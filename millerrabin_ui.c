@@ -0,0 +1,53 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Bases found by J. Sinclair such that every odd composite smaller
+ * than 2^64 is revealed as composite by one of them.
+ */
+static const unsigned long int bases[] =
+  {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+int
+gmpmee_millerrabin_ui(unsigned long int n)
+{
+  size_t i;
+
+  if (n < 4)
+    {
+      return n > 1;
+    }
+  if ((n & 1) == 0)
+    {
+      return 0;
+    }
+
+  /* A base divisible by n says nothing about n. */
+  for (i = 0; i < sizeof(bases) / sizeof(bases[0]); i++)
+    {
+      if (bases[i] % n != 0 && !gmpmee_millerrabin_once_ui(n, bases[i]))
+	{
+	  return 0;
+	}
+    }
+  return 1;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns -1/m0 modulo 2^GMP_NUMB_BITS for an odd limb m0. Every odd
+ * limb is its own inverse modulo 8, and each Newton iteration
+ * doubles the number of correct bits.
+ */
+static mp_limb_t
+minus_inverse_limb(mp_limb_t m0)
+{
+  int i;
+  mp_limb_t inv = m0;
+
+  for (i = 3; i < GMP_NUMB_BITS; i *= 2)
+    {
+      inv *= 2 - m0 * inv;
+    }
+  return -inv;
+}
+
+void
+gmpmee_mont_set(gmpmee_mont mont, mpz_t modulus)
+{
+  mp_size_t size;
+
+  /* Montgomery representation is only defined for odd moduli. */
+  if (mpz_cmp_ui(modulus, 3) < 0 || mpz_even_p(modulus))
+    {
+      mpz_set_ui(mont->modulus, 0);
+      mont->size = 0;
+      return;
+    }
+
+  mpz_set(mont->modulus, modulus);
+  size = mpz_size(modulus);
+
+  /* Buffers are only reallocated if they are too small. */
+  if (size > mont->alloc)
+    {
+      free(mont->tp);
+      free(mont->xp);
+      free(mont->minus_one);
+      free(mont->one);
+      free(mont->mp);
+
+      mont->mp = (mp_limb_t *)malloc(size * sizeof(mp_limb_t));
+      mont->one = (mp_limb_t *)malloc(size * sizeof(mp_limb_t));
+      mont->minus_one = (mp_limb_t *)malloc(size * sizeof(mp_limb_t));
+      mont->xp = (mp_limb_t *)malloc(size * sizeof(mp_limb_t));
+      mont->tp = (mp_limb_t *)malloc(2 * size * sizeof(mp_limb_t));
+      mont->alloc = size;
+    }
+  mont->size = size;
+
+  gmpmee_mont_limbs(mont->mp, modulus, size);
+  mont->minv = minus_inverse_limb(mont->mp[0]);
+
+  /* Representations of 1 and -1. */
+  mpz_set_ui(mont->tmp, 1);
+  gmpmee_mont_to(mont->one, mont->tmp, mont);
+  mpn_sub_n(mont->minus_one, mont->mp, mont->one, size);
+}
@@ -23,6 +23,8 @@
 void
 mpz_probab_prime_p_next(mpz_t rop, mpz_t n, int reps)
 {
+  gmpmee_sieve sieve;
+
   mpz_set(rop, n);
 
   if (mpz_cmp_ui(rop, 2) < 0)
@@ -41,9 +43,13 @@ mpz_probab_prime_p_next(mpz_t rop, mpz_t n, int reps)
           mpz_add_ui(rop, rop, 1L);
         }
 
-      while (mpz_probab_prime_p(rop, reps) == 0)
+      /* Only test odd integers without small factors. */
+      gmpmee_sieve_init_ui(sieve, rop, 2L);
+      do
         {
-          mpz_add_ui(rop, rop, 2L);
+          gmpmee_sieve_next(rop, sieve);
         }
+      while (mpz_probab_prime_p(rop, reps) == 0);
+      gmpmee_sieve_clear(sieve);
     }
 }
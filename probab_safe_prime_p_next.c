@@ -24,6 +24,7 @@ void
 mpz_probab_safe_prime_p_next(mpz_t rop, mpz_t n, int reps)
 {
   int increased = 0;
+  gmpmee_sieve sieve;
 
   mpz_set(rop, n);
 
@@ -58,9 +59,14 @@ mpz_probab_safe_prime_p_next(mpz_t rop, mpz_t n, int reps)
           mpz_add_ui(rop, rop, 4L);
         }
 
-      while (mpz_probab_safe_prime_p(rop, reps) == 0)
+      /* Only test integers n such that neither n nor (n-1)/2 has a
+         small factor. */
+      gmpmee_sieve_safe_init_ui(sieve, rop, 4L);
+      do
         {
-          mpz_add_ui(rop, rop, 4L);
+          gmpmee_sieve_next(rop, sieve);
         }
+      while (mpz_probab_safe_prime_p(rop, reps) == 0);
+      gmpmee_sieve_clear(sieve);
     }
 }
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_random_safe_prime_mt_rs(mpz_t rop, gmp_randstate_t rstate,
+			       unsigned long int bits, int reps,
+			       unsigned int nthreads)
+{
+  size_t max_cands;
+  gmpmee_sieve sieve;
+  mpz_t start;
+
+  /* The only safe prime congruent to 1 modulo 4 is 5. */
+  if (bits <= 3)
+    {
+      mpz_set_ui(rop, 5 + 2 * gmp_urandomb_ui(rstate, 1));
+      return;
+    }
+
+  /* On average about 3 * bits / 4 candidates that survive the sieve
+     are tested before a safe prime is found. */
+  max_cands = 2 * bits + 16;
+
+  mpz_init(start);
+  for (;;)
+    {
+      /* Random integer of the given bit length congruent to 3 modulo
+	 4. */
+      mpz_urandomb(start, rstate, bits);
+      mpz_setbit(start, bits - 1);
+      mpz_setbit(start, 1);
+      mpz_setbit(start, 0);
+
+      gmpmee_sieve_safe_init_ui(sieve, start, 4L);
+      if (gmpmee_millerrabin_search_rs(rop, rstate, sieve, reps, max_cands,
+				       nthreads)
+	  && mpz_sizeinbase(rop, 2) == bits)
+	{
+	  break;
+	}
+      gmpmee_sieve_clear(sieve);
+    }
+
+  gmpmee_sieve_clear(sieve);
+  mpz_clear(start);
+}
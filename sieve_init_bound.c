@@ -0,0 +1,175 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns the inverse of a modulo the odd prime p, where a is
+ * non-zero modulo p.
+ */
+static unsigned long int
+invert_ui(unsigned long int a, unsigned long int p)
+{
+  long int t = 0;
+  long int new_t = 1;
+  long int tmp;
+  unsigned long int r = p;
+  unsigned long int new_r = a;
+  unsigned long int quotient;
+  unsigned long int tmp_r;
+
+  while (new_r != 0)
+    {
+      quotient = r / new_r;
+
+      tmp = t - (long int)quotient * new_t;
+      t = new_t;
+      new_t = tmp;
+
+      tmp_r = r - quotient * new_r;
+      r = new_r;
+      new_r = tmp_r;
+    }
+
+  if (t < 0)
+    {
+      t += p;
+    }
+  return (unsigned long int)t;
+}
+
+void
+gmpmee_sieve_init_bound(gmpmee_sieve sieve, mpz_t start, mpz_t step,
+			unsigned long int bound, int safe)
+{
+  size_t i;
+  size_t j;
+  size_t bitlen;
+  size_t max_len;
+  unsigned long int p;
+  unsigned long int r;
+  unsigned long int s;
+  unsigned long int s_inv;
+  unsigned long int *primes;
+  size_t primes_len;
+
+  bitlen = mpz_sizeinbase(start, 2);
+
+  /* The window holds a number of offsets proportional to the bit
+     length, since so is the expected distance between primes. Safe
+     primes are much more sparse, so we use larger windows. */
+  if (safe)
+    {
+      sieve->len = 64 * bitlen;
+      max_len = GMPMEE_SIEVE_SAFE_MAX_LEN;
+    }
+  else
+    {
+      sieve->len = 16 * bitlen;
+      max_len = GMPMEE_SIEVE_MAX_LEN;
+    }
+  if (sieve->len < GMPMEE_SIEVE_MIN_LEN)
+    {
+      sieve->len = GMPMEE_SIEVE_MIN_LEN;
+    }
+  if (sieve->len > max_len)
+    {
+      sieve->len = max_len;
+    }
+
+  /* Every sieving prime must be smaller than start, since otherwise
+     the sieve would remove the prime itself. In safe mode every
+     sieving prime p must also satisfy 2p+1 < start for the same
+     reason. */
+  if (safe)
+    {
+      if (mpz_cmp_ui(start, 5) < 0)
+	{
+	  bound = 0;
+	}
+      else if (mpz_cmp_ui(start, 2 * bound + 3) < 0)
+	{
+	  bound = (mpz_get_ui(start) - 1) / 2 - 1;
+	}
+    }
+  else if (mpz_cmp_ui(start, bound) <= 0)
+    {
+      bound = mpz_get_ui(start) - 1;
+    }
+
+  primes = gmpmee_small_primes(&primes_len, bound);
+
+  sieve->primes = (unsigned long int *)
+    malloc((primes_len + 1) * sizeof(unsigned long int));
+  sieve->offsets = (unsigned long int *)
+    malloc((primes_len + 1) * sizeof(unsigned long int));
+  if (safe)
+    {
+      sieve->safe_offsets = (unsigned long int *)
+	malloc((primes_len + 1) * sizeof(unsigned long int));
+    }
+  else
+    {
+      sieve->safe_offsets = NULL;
+    }
+
+  /* Find the smallest offset i such that start + i * step is
+     divisible by each prime p, and in safe mode also the smallest
+     offset i such that start + i * step - 1 is divisible by p. Primes
+     that divide the step never divide any integer in the progression
+     or divide all of them, so we do not use them. */
+  j = 0;
+  for (i = 0; i < primes_len; i++)
+    {
+      p = primes[i];
+      s = mpz_fdiv_ui(step, p);
+      if (s != 0)
+	{
+	  r = mpz_fdiv_ui(start, p);
+	  s_inv = invert_ui(s, p);
+
+	  sieve->primes[j] = p;
+	  sieve->offsets[j] =
+	    (unsigned long int)(((unsigned long long int)(p - r) % p)
+				* s_inv % p);
+	  if (safe)
+	    {
+	      sieve->safe_offsets[j] =
+		(unsigned long int)(((unsigned long long int)(p + 1 - r) % p)
+				    * s_inv % p);
+	    }
+	  j++;
+	}
+    }
+  sieve->primes_len = j;
+  sieve->safe = safe;
+  free(primes);
+
+  mpz_init_set(sieve->step, step);
+
+  /* The window is filled when the first candidate is requested, at
+     which point the base is moved forward to start. */
+  mpz_init(sieve->base);
+  mpz_mul_ui(sieve->base, step, sieve->len);
+  mpz_sub(sieve->base, start, sieve->base);
+  sieve->index = sieve->len;
+  sieve->window = (unsigned char *)malloc(sieve->len);
+}
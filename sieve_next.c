@@ -0,0 +1,94 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Moves the window forward and marks every offset in the new window
+ * at which some sieving prime divides the integer.
+ */
+static void
+sieve_fill(gmpmee_sieve sieve)
+{
+  size_t j;
+  unsigned long int p;
+  unsigned long int offset;
+  unsigned long int len = sieve->len;
+  unsigned char *window = sieve->window;
+
+  mpz_addmul_ui(sieve->base, sieve->step, len);
+
+  memset(window, 0, len);
+
+  for (j = 0; j < sieve->primes_len; j++)
+    {
+      p = sieve->primes[j];
+      for (offset = sieve->offsets[j]; offset < len; offset += p)
+	{
+	  window[offset] = 1;
+	}
+
+      /* Offset relative to the next window. */
+      sieve->offsets[j] = offset - len;
+    }
+
+  /* In safe mode we also remove integers n such that (n-1)/2 has a
+     small factor. */
+  if (sieve->safe)
+    {
+      for (j = 0; j < sieve->primes_len; j++)
+	{
+	  p = sieve->primes[j];
+	  for (offset = sieve->safe_offsets[j]; offset < len; offset += p)
+	    {
+	      window[offset] = 1;
+	    }
+	  sieve->safe_offsets[j] = offset - len;
+	}
+    }
+
+  sieve->index = 0;
+}
+
+void
+gmpmee_sieve_next(mpz_t rop, gmpmee_sieve sieve)
+{
+  for (;;)
+    {
+      if (sieve->index == sieve->len)
+	{
+	  sieve_fill(sieve);
+	}
+
+      while (sieve->index < sieve->len && sieve->window[sieve->index])
+	{
+	  sieve->index++;
+	}
+
+      if (sieve->index < sieve->len)
+	{
+	  mpz_set(rop, sieve->base);
+	  mpz_addmul_ui(rop, sieve->step, sieve->index);
+	  sieve->index++;
+	  return;
+	}
+    }
+}
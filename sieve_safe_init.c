@@ -0,0 +1,52 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Returns a bound on the sieving primes suitable for safe-prime
+ * candidates of the given bit length. A candidate that survives the
+ * sieve costs at least one exponentiation, and each sieving prime p
+ * removes a fraction 2/p of the candidates, so it pays off to sieve
+ * much deeper than for primes.
+ */
+static unsigned long int
+sieve_safe_bound(size_t bitlen)
+{
+  if (bitlen < GMPMEE_SIEVE_MIN_BOUND / 512)
+    {
+      return GMPMEE_SIEVE_MIN_BOUND;
+    }
+  else if (bitlen > GMPMEE_SIEVE_SAFE_MAX_BOUND / 512)
+    {
+      return GMPMEE_SIEVE_SAFE_MAX_BOUND;
+    }
+  else
+    {
+      return 512 * bitlen;
+    }
+}
+
+void
+gmpmee_sieve_safe_init(gmpmee_sieve sieve, mpz_t start, mpz_t step)
+{
+  gmpmee_sieve_init_bound(sieve, start, step,
+			  sieve_safe_bound(mpz_sizeinbase(start, 2)), 1);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+unsigned long int *
+gmpmee_small_primes(size_t *len, unsigned long int bound)
+{
+  unsigned long int i;
+  unsigned long int j;
+  unsigned char *composite;
+  unsigned long int *primes;
+
+  *len = 0;
+  if (bound < 3)
+    {
+      return (unsigned long int *)malloc(sizeof(unsigned long int));
+    }
+
+  /* Sieve of Eratosthenes over the integers in [0,bound]. */
+  composite = (unsigned char *)malloc(bound + 1);
+  memset(composite, 0, bound + 1);
+  for (i = 3; i * i <= bound; i += 2)
+    {
+      if (!composite[i])
+	{
+	  for (j = i * i; j <= bound; j += 2 * i)
+	    {
+	      composite[j] = 1;
+	    }
+	}
+    }
+
+  /* There are less than bound/2 odd primes in [3,bound]. */
+  primes = (unsigned long int *)malloc((bound / 2 + 1) *
+				       sizeof(unsigned long int));
+  for (i = 3; i <= bound; i += 2)
+    {
+      if (!composite[i])
+	{
+	  primes[(*len)++] = i;
+	}
+    }
+
+  free(composite);
+  return primes;
+}
@@ -77,9 +77,12 @@ size_t best_block_widths[GMPMEE_SPOWM_ROWS][GMPMEE_SPOWM_COLUMNS] =
 /* 4096 */ {100, 200, 350,  900, 2000, 4400, 7300,  0}
 };
 
-void
-gmpmee_spowm(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
-	     mpz_t modulus)
+/*
+ * Computes a simultaneous exponentiation with the block width chosen
+ * from the tables above and returns the block width.
+ */
+static size_t
+spowm(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len, mpz_t modulus)
 {
   size_t i;
   int row;
@@ -142,4 +145,25 @@ gmpmee_spowm(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
 
   gmpmee_spowm_block_batch(rop, bases, exponents, len, modulus, block_width,
 			   batch_len);
+
+  return block_width;
+}
+
+void
+gmpmee_spowm(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
+	     mpz_t modulus)
+{
+  size_t block_width;
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_SPOWM, modulus,
+				  exponents, len);
+
+  block_width = spowm(rop, bases, exponents, len, modulus);
+
+  if (traced)
+    {
+      record->block_width = block_width;
+      record->batch_len = len;
+      gmpmee_trace_leave(record);
+    }
 }
@@ -20,9 +20,9 @@
 #include <gmp.h>
 #include "gmpmee.h"
 
-void
-gmpmee_spowm_block_batch(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
-			 mpz_t modulus, size_t block_width, size_t batch_len)
+static void
+block_batch(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
+	    mpz_t modulus, size_t block_width, size_t batch_len)
 {
   size_t i;
   gmpmee_spowm_tab table;
@@ -55,6 +55,8 @@ gmpmee_spowm_block_batch(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
       /* Multiply with result so far. */
       mpz_mul(rop, rop, tmp);
       mpz_mod(rop, rop, modulus);
+      GMPMEE_STATS_INC(mul);
+      GMPMEE_STATS_INC(redc);
 
       /* Move on to next batch. */
       bases += batch_len;
@@ -63,3 +65,21 @@ gmpmee_spowm_block_batch(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
   mpz_clear(tmp);
   gmpmee_spowm_clear(table);
 }
+
+void
+gmpmee_spowm_block_batch(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
+			 mpz_t modulus, size_t block_width, size_t batch_len)
+{
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_SPOWM_BLOCK_BATCH,
+				  modulus, exponents, len);
+
+  block_batch(rop, bases, exponents, len, modulus, block_width, batch_len);
+
+  if (traced)
+    {
+      record->block_width = block_width;
+      record->batch_len = batch_len;
+      gmpmee_trace_leave(record);
+    }
+}
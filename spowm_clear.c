@@ -30,7 +30,7 @@ gmpmee_spowm_clear(gmpmee_spowm_tab table)
   size_t block_width = table->block_width;
   size_t tab_len = 1 << block_width;
 
-  for (i = 0; i < tabs_len; i++)
+  for (i = 0; table->tabs != NULL && i < tabs_len; i++)
     {
 
       /* Last block may have smaller width, but it is never zero. */
@@ -54,5 +54,7 @@ gmpmee_spowm_clear(gmpmee_spowm_tab table)
   /* Deallocate table of tables. */
   free(table->tabs);
 
+  free(table->mtabs);
+  gmpmee_mont_clear(table->mont);
   mpz_clear(table->modulus);
 }
@@ -35,10 +35,27 @@ gmpmee_spowm_init(gmpmee_spowm_tab table, size_t len, mpz_t modulus,
     table->block_width = len;
   }
   table->tabs_len = (len + block_width - 1) / block_width;
+  GMPMEE_STATS_SET(block_width, table->block_width);
+  GMPMEE_STATS_SET(batch_len, len);
 
   mpz_init(table->modulus);
   mpz_set(table->modulus, modulus);
 
+  /* Montgomery representations are only defined for odd moduli. */
+  gmpmee_mont_init(table->mont);
+  gmpmee_mont_set(table->mont, modulus);
+  table->mtabs = NULL;
+  if (table->mont->size > 0)
+    {
+      table->mtabs = (mp_limb_t *)
+	malloc((table->tabs_len << table->block_width) * table->mont->size
+	       * sizeof(mp_limb_t));
+
+      /* Only the Montgomery table is used for odd moduli. */
+      table->tabs = NULL;
+      return;
+    }
+
   /* Allocate and initialize space for pointers to tables. */
   table->tabs = (mpz_t **)malloc(table->tabs_len * sizeof(mpz_t *));
 
@@ -20,9 +20,8 @@
 #include <gmp.h>
 #include "gmpmee.h"
 
-void
-gmpmee_spowm_naive(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
-		   mpz_t modulus)
+static void
+naive(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len, mpz_t modulus)
 {
   size_t i;
   mpz_t tmp;
@@ -35,7 +34,26 @@ gmpmee_spowm_naive(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
       mpz_powm(tmp, bases[i], exponents[i], modulus);
       mpz_mul(rop, rop, tmp);
       mpz_mod(rop, rop, modulus);
+      GMPMEE_STATS_INC(powm);
+      GMPMEE_STATS_INC(mul);
+      GMPMEE_STATS_INC(redc);
     }
 
   mpz_clear(tmp);
 }
+
+void
+gmpmee_spowm_naive(mpz_t rop, mpz_t *bases, mpz_t *exponents, size_t len,
+		   mpz_t modulus)
+{
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_SPOWM_NAIVE, modulus,
+				  exponents, len);
+
+  naive(rop, bases, exponents, len, modulus);
+
+  if (traced)
+    {
+      gmpmee_trace_leave(record);
+    }
+}
@@ -21,8 +21,47 @@
 #include <gmp.h>
 #include "gmpmee.h"
 
-void
-gmpmee_spowm_precomp(gmpmee_spowm_tab table, mpz_t *bases)
+#ifdef GMPMEE_STATS
+
+/*
+ * Returns the number of bytes allocated for the table, including
+ * the limbs of its integers.
+ */
+static size_t
+table_bytes(gmpmee_spowm_tab table)
+{
+  size_t i, j;
+  size_t tab_len;
+  size_t block_width = table->block_width;
+  size_t bytes;
+
+  if (table->mtabs != NULL)
+    {
+      return (table->tabs_len << table->block_width) * table->mont->size
+        * sizeof(mp_limb_t);
+    }
+
+  bytes = table->tabs_len * sizeof(mpz_t *);
+  for (i = 0; i < table->tabs_len; i++)
+    {
+      if (i == table->tabs_len - 1)
+        {
+          block_width = table->len - (table->tabs_len - 1) * block_width;
+        }
+      tab_len = (size_t)1 << block_width;
+      bytes += tab_len * sizeof(mpz_t);
+      for (j = 0; j < tab_len; j++)
+        {
+          bytes += mpz_size(table->tabs[i][j]) * sizeof(mp_limb_t);
+        }
+    }
+  return bytes;
+}
+
+#endif
+
+static void
+precomp(gmpmee_spowm_tab table, mpz_t *bases)
 {
   size_t i, j;
   size_t tabs_len = table->tabs_len;
@@ -58,8 +97,85 @@ gmpmee_spowm_precomp(gmpmee_spowm_tab table, mpz_t *bases)
           one_mask = mask & (-mask);
           mpz_mul(t[mask], t[mask ^ one_mask], t[one_mask]);
           mpz_mod(t[mask], t[mask], table->modulus);
+          GMPMEE_STATS_INC(mul);
+          GMPMEE_STATS_INC(redc);
         }
 
       bases += block_width;
     }
 }
+
+/*
+ * Same as precomp, but the products are computed in Montgomery
+ * representation by the Montgomery kernels and only stored in the
+ * Montgomery table.
+ */
+static void
+precomp_mont(gmpmee_spowm_tab table, mpz_t *bases)
+{
+  size_t i, j;
+  size_t tabs_len = table->tabs_len;
+  size_t block_width = table->block_width;
+  mp_size_t size = table->mont->size;
+  int mask;
+  int one_mask;
+  mp_limb_t *mt;
+
+  for (i = 0; i < tabs_len; i++)
+    {
+      /* Last block may have smaller width, but it is never zero. */
+      if (i == tabs_len - 1)
+        {
+          block_width = table->len - (tabs_len - 1) * block_width;
+        }
+
+      mt = table->mtabs + (i << table->block_width) * size;
+
+      /* Trivial products. */
+      mpn_copyi(mt, table->mont->one, size);
+      mask = 1;
+      for (j = 0; j < block_width; j++)
+        {
+          gmpmee_mont_to(mt + mask * size, bases[j], table->mont);
+          mask <<= 1;
+        }
+
+      /* Non-trivial products. */
+      for (mask = 1; mask < (1 << block_width); mask++)
+        {
+          one_mask = mask & (-mask);
+          if (mask != one_mask)
+            {
+              gmpmee_mont_mul(mt + mask * size, mt + (mask ^ one_mask) * size,
+                              mt + one_mask * size, table->mont);
+            }
+        }
+
+      bases += block_width;
+    }
+}
+
+void
+gmpmee_spowm_precomp(gmpmee_spowm_tab table, mpz_t *bases)
+{
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_SPOWM_PRECOMP,
+				  table->modulus, NULL, table->len);
+
+  if (table->mtabs != NULL)
+    {
+      GMPMEE_STATS_TIME(precomp_seconds, precomp_mont(table, bases));
+    }
+  else
+    {
+      GMPMEE_STATS_TIME(precomp_seconds, precomp(table, bases));
+    }
+  GMPMEE_STATS_MAX(table_bytes, table_bytes(table));
+
+  if (traced)
+    {
+      record->block_width = table->block_width;
+      record->batch_len = table->len;
+      gmpmee_trace_leave(record);
+    }
+}
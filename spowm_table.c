@@ -17,6 +17,7 @@
  * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdlib.h>
 #include <gmp.h>
 #include "gmpmee.h"
 
@@ -42,8 +43,8 @@ getbits(mpz_t *op, int index, size_t block_width)
   return bits;
 }
 
-void
-gmpmee_spowm_table(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
+static void
+table_powm(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
 {
   size_t i;
   int index;
@@ -78,6 +79,8 @@ gmpmee_spowm_table(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
       /* Square ... */
       mpz_mul(rop, rop, rop);
       mpz_mod(rop, rop, table->modulus);
+      GMPMEE_STATS_INC(sqr);
+      GMPMEE_STATS_INC(redc);
 
       /* ... and multiply. */
       i = 0;
@@ -98,8 +101,103 @@ gmpmee_spowm_table(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
 
 	  mpz_mul(rop, rop, tabs[i][mask]);
           mpz_mod(rop, rop, table->modulus);
+          GMPMEE_STATS_INC(mul);
+          GMPMEE_STATS_INC(redc);
 	  i++;
 	  exps += block_width;
 	}
     }
 }
+
+/*
+ * Same as table_powm, but computed in Montgomery representation by
+ * the Montgomery kernels using the Montgomery table. The temporary
+ * space is local, so a table may be used by several threads.
+ */
+static void
+table_powm_mont(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
+{
+  size_t i;
+  int index;
+  int mask;
+  size_t bitlen;
+  size_t max_exponent_bitlen;
+  size_t len = table->len;
+  size_t tabs_len = table->tabs_len;
+  size_t block_width = table->block_width;
+  size_t last_block_width = len - (tabs_len - 1) * block_width;
+  const mp_limb_t *mp = table->mont->mp;
+  mp_size_t n = table->mont->size;
+  mp_limb_t minv = table->mont->minv;
+  mp_limb_t *yp;
+  mp_limb_t *tp;
+  mp_limb_t *rp;
+
+  max_exponent_bitlen = 0;
+  for (i = 0; i < len; i++)
+    {
+      bitlen = mpz_sizeinbase(exponents[i], 2);
+      if (bitlen > max_exponent_bitlen)
+        {
+          max_exponent_bitlen = bitlen;
+        }
+    }
+
+  yp = (mp_limb_t *)malloc(3 * n * sizeof(mp_limb_t));
+  tp = yp + n;
+  mpn_copyi(yp, table->mont->one, n);
+
+  for (index = max_exponent_bitlen - 1; index >= 0; index--)
+    {
+      gmpmee_kernels->sqr(yp, yp, mp, n, minv, tp);
+      GMPMEE_STATS_INC(sqr);
+      GMPMEE_STATS_INC(redc);
+
+      for (i = 0; i < tabs_len; i++)
+        {
+          mask = getbits(exponents + i * block_width, index,
+                         i == tabs_len - 1 ? last_block_width : block_width);
+          gmpmee_kernels->mul(yp, yp,
+                              table->mtabs
+                              + ((i << block_width) + mask) * n,
+                              mp, n, minv, tp);
+          GMPMEE_STATS_INC(mul);
+          GMPMEE_STATS_INC(redc);
+        }
+    }
+
+  /* Reduce y padded with zeros, i.e., multiply by 1/R. */
+  mpn_zero(tp + n, n);
+  mpn_copyi(tp, yp, n);
+  rp = mpz_limbs_write(rop, n);
+  gmpmee_kernels->redc(rp, tp, mp, n, minv);
+  mpz_limbs_finish(rop, n);
+  GMPMEE_STATS_INC(redc);
+
+  free(yp);
+}
+
+void
+gmpmee_spowm_table(mpz_t rop, gmpmee_spowm_tab table, mpz_t *exponents)
+{
+  gmpmee_trace_record record;
+  int traced = gmpmee_trace_enter(record, GMPMEE_TRACE_SPOWM_TABLE,
+				  table->modulus, exponents, table->len);
+
+  if (table->mtabs != NULL)
+    {
+      GMPMEE_STATS_TIME(eval_seconds,
+                        table_powm_mont(rop, table, exponents));
+    }
+  else
+    {
+      GMPMEE_STATS_TIME(eval_seconds, table_powm(rop, table, exponents));
+    }
+
+  if (traced)
+    {
+      record->block_width = table->block_width;
+      record->batch_len = table->len;
+      gmpmee_trace_leave(record);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_stats_add(gmpmee_stats op)
+{
+#ifdef GMPMEE_STATS
+  gmpmee_stats_struct *s = &gmpmee_stats_local;
+
+  s->sqr += op->sqr;
+  s->mul += op->mul;
+  s->redc += op->redc;
+  s->powm += op->powm;
+  s->lanes_sqr += op->lanes_sqr;
+  s->lanes_mul += op->lanes_mul;
+  s->mr_rounds += op->mr_rounds;
+  s->lucas += op->lucas;
+  if (op->table_bytes > s->table_bytes)
+    {
+      s->table_bytes = op->table_bytes;
+    }
+  if (op->block_width > 0)
+    {
+      s->block_width = op->block_width;
+      s->batch_len = op->batch_len;
+    }
+  s->precomp_seconds += op->precomp_seconds;
+  s->eval_seconds += op->eval_seconds;
+#else
+  GMPMEE_UNUSED(op);
+#endif
+}
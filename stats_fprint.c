@@ -0,0 +1,45 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_stats_fprint(FILE *stream, gmpmee_stats op)
+{
+  fprintf(stream,
+	  "sqr             %lu\n"
+	  "mul             %lu\n"
+	  "redc            %lu\n"
+	  "powm            %lu\n"
+	  "lanes_sqr       %lu\n"
+	  "lanes_mul       %lu\n"
+	  "mr_rounds       %lu\n"
+	  "lucas           %lu\n"
+	  "table_bytes     %zu\n"
+	  "block_width     %zu\n"
+	  "batch_len       %zu\n"
+	  "precomp_seconds %.6f\n"
+	  "eval_seconds    %.6f\n",
+	  op->sqr, op->mul, op->redc, op->powm,
+	  op->lanes_sqr, op->lanes_mul, op->mr_rounds, op->lucas,
+	  op->table_bytes, op->block_width, op->batch_len,
+	  op->precomp_seconds, op->eval_seconds);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_trace_begin(gmpmee_trace_record record, int op, mpz_t modulus,
+		   mpz_t *exponents, size_t len)
+{
+  size_t i;
+  size_t bitlen;
+
+  /* Calls made by a traced call are part of the traced call. */
+  if (gmpmee_trace_hook == NULL || gmpmee_trace_active)
+    {
+      return 0;
+    }
+  gmpmee_trace_active = 1;
+
+  record->op = op;
+  record->len = len;
+  record->modulus_bitlen = mpz_sizeinbase(modulus, 2);
+  record->exponent_bitlen = 0;
+  if (exponents != NULL)
+    {
+      for (i = 0; i < len; i++)
+	{
+	  bitlen = mpz_sizeinbase(exponents[i], 2);
+	  if (bitlen > record->exponent_bitlen)
+	    {
+	      record->exponent_bitlen = bitlen;
+	    }
+	}
+    }
+  record->block_width = 0;
+  record->batch_len = 0;
+  record->seconds = gmpmee_stats_seconds();
+
+  return 1;
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+void
+gmpmee_trace_fprint(gmpmee_trace_record_struct *record, void *stream)
+{
+  /* A single call writes the complete line, so lines written by
+     different threads are not interleaved. */
+  fprintf((FILE *)stream, "%s %zu %zu %zu %zu %zu %.9f\n",
+	  gmpmee_trace_name(record->op), record->len,
+	  record->modulus_bitlen, record->exponent_bitlen,
+	  record->block_width, record->batch_len, record->seconds);
+}
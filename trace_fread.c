@@ -0,0 +1,63 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Longest line that is parsed.
+ */
+#define LINE_LEN 256
+
+int
+gmpmee_trace_fread(gmpmee_trace_record record, FILE *stream)
+{
+  int op;
+  char line[LINE_LEN];
+  char name[LINE_LEN];
+
+  do
+    {
+      if (fgets(line, LINE_LEN, stream) == NULL)
+	{
+	  return 0;
+	}
+    }
+  while (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0');
+
+  if (sscanf(line, "%255s %zu %zu %zu %zu %zu %lf", name, &record->len,
+	     &record->modulus_bitlen, &record->exponent_bitlen,
+	     &record->block_width, &record->batch_len,
+	     &record->seconds) != 7)
+    {
+      return 0;
+    }
+
+  for (op = 1; op < GMPMEE_TRACE_OPS; op++)
+    {
+      if (strcmp(name, gmpmee_trace_name(op)) == 0)
+	{
+	  record->op = op;
+	  return 1;
+	}
+    }
+  return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+/*
+ * Trial division of an integer that fits in a word by the primes of
+ * the given number of groups, where only primes smaller than the
+ * integer, or in safe mode smaller than (n-1)/2, may be used.
+ */
+static int
+trial_ui(const gmpmee_trial_table_struct *table, size_t groups,
+	 unsigned long int n, int safe)
+{
+  size_t i;
+  unsigned long int bound = safe ? n / 2 : n;
+
+  for (i = 0; i < table->starts[groups] && table->primes[i] < bound; i++)
+    {
+      if (GMPMEE_TRIAL_DIVIDES(table, i, n)
+	  || (safe && GMPMEE_TRIAL_DIVIDES(table, i, n - 1)))
+	{
+	  return 0;
+	}
+    }
+  return 1;
+}
+
+int
+gmpmee_trial(mpz_t n, int safe)
+{
+  size_t g;
+  size_t groups;
+  const gmpmee_trial_table_struct *table = gmpmee_trial_table();
+
+  groups = gmpmee_trial_groups(mpz_sizeinbase(n, 2), safe);
+
+  if (mpz_fits_ulong_p(n))
+    {
+      return trial_ui(table, groups, mpz_get_ui(n), safe);
+    }
+
+  if (!safe && mpz_sizeinbase(n, 2) >= GMPMEE_TRIAL_GCD_MIN_BITLEN)
+    {
+      return gmpmee_trial_gcd(n, groups);
+    }
+
+  for (g = 0; g < groups; g++)
+    {
+      if (!gmpmee_trial_group(table, g, mpz_tdiv_ui(n, table->products[g]),
+			      safe))
+	{
+	  return 0;
+	}
+    }
+  return 1;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_trial_gcd(mpz_t n, size_t groups)
+{
+  int res;
+  size_t g;
+  size_t i;
+  mpz_t x;
+  const gmpmee_trial_table_struct *table = gmpmee_trial_table();
+  const gmpmee_trial_primorials_struct *primorials;
+
+  /* Most candidates are removed by the smallest primes, so these are
+     tested one by one to stop early. */
+  for (g = 0; g < groups && g < GMPMEE_TRIAL_GCD_HEAD; g++)
+    {
+      if (!gmpmee_trial_group(table, g, mpz_tdiv_ui(n, table->products[g]),
+			      0))
+	{
+	  return 0;
+	}
+    }
+  if (groups <= GMPMEE_TRIAL_GCD_HEAD)
+    {
+      return 1;
+    }
+
+  /* The ranges grow geometrically, so the candidates that are
+     removed early cost little. */
+  primorials = gmpmee_trial_primorials();
+  mpz_init(x);
+
+  res = 1;
+  for (i = 0; res && i < primorials->len; i++)
+    {
+      mpz_gcd(x, n, primorials->products[i]);
+      res = mpz_cmp_ui(x, 1) == 0;
+
+      if (primorials->ends[i] >= groups)
+	{
+	  break;
+	}
+    }
+
+  mpz_clear(x);
+
+  return res;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+int
+gmpmee_trial_group(const gmpmee_trial_table_struct *table, size_t group,
+		   unsigned long int r, int safe)
+{
+  size_t i;
+
+  for (i = table->starts[group]; i < table->starts[group + 1]; i++)
+    {
+      if (GMPMEE_TRIAL_DIVIDES(table, i, r))
+	{
+	  return 0;
+	}
+    }
+
+  /* Here r is not zero, since no prime of the group divides it. */
+  if (safe)
+    {
+      r--;
+      for (i = table->starts[group]; i < table->starts[group + 1]; i++)
+	{
+	  if (GMPMEE_TRIAL_DIVIDES(table, i, r))
+	    {
+	      return 0;
+	    }
+	}
+    }
+  return 1;
+}
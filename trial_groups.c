@@ -0,0 +1,71 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmp.h>
+#include "gmpmee.h"
+
+size_t
+gmpmee_trial_groups(size_t bitlen, int safe)
+{
+  size_t low;
+  size_t high;
+  size_t mid;
+  unsigned long int bound;
+  const gmpmee_trial_table_struct *table = gmpmee_trial_table();
+
+  /* An exponentiation modulo an integer of the given bit length
+     costs about 0.01 * bitlen^2 remainders modulo a word, and a
+     group of k primes close to p removes a fraction k/p of the
+     remaining candidates, or 2k/p in safe mode. Groups hold at least
+     three primes, so a group pays off if p < bitlen^2 / 32, or
+     p < bitlen^2 / 16 in safe mode. */
+  if (bitlen > 8192)
+    {
+      bound = GMPMEE_TRIAL_MAX_BOUND;
+    }
+  else
+    {
+      bound = (unsigned long int)bitlen * bitlen / (safe ? 16 : 32);
+    }
+  if (bound < GMPMEE_TRIAL_MIN_BOUND)
+    {
+      bound = GMPMEE_TRIAL_MIN_BOUND;
+    }
+  else if (bound > GMPMEE_TRIAL_MAX_BOUND)
+    {
+      bound = GMPMEE_TRIAL_MAX_BOUND;
+    }
+
+  /* Number of groups whose first prime is at most the bound. */
+  low = 0;
+  high = table->len;
+  while (low < high)
+    {
+      mid = low + (high - low) / 2;
+      if (table->primes[table->starts[mid]] <= bound)
+	{
+	  low = mid + 1;
+	}
+      else
+	{
+	  high = mid;
+	}
+    }
+  return low;
+}
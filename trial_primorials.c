@@ -0,0 +1,95 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+static gmpmee_trial_primorials_struct primorials;
+static pthread_once_t primorials_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Sets rop to the product of the groups with indices in [start,end)
+ * by recursively splitting the range in halves, which is much faster
+ * than multiplying by one group at a time.
+ */
+static void
+range_product(mpz_t rop, const gmpmee_trial_table_struct *table,
+	      size_t start, size_t end)
+{
+  size_t mid;
+  mpz_t tmp;
+
+  if (end - start <= 16)
+    {
+      mpz_set_ui(rop, 1);
+      for (; start < end; start++)
+	{
+	  mpz_mul_ui(rop, rop, table->products[start]);
+	}
+    }
+  else
+    {
+      mid = start + (end - start) / 2;
+      mpz_init(tmp);
+      range_product(rop, table, start, mid);
+      range_product(tmp, table, mid, end);
+      mpz_mul(rop, rop, tmp);
+      mpz_clear(tmp);
+    }
+}
+
+static void
+primorials_init(void)
+{
+  size_t i;
+  size_t start;
+  size_t end;
+  const gmpmee_trial_table_struct *table = gmpmee_trial_table();
+
+  /* Number of products. */
+  primorials.len = 0;
+  end = GMPMEE_TRIAL_GCD_HEAD;
+  do
+    {
+      end = 2 * end < table->len ? 2 * end : table->len;
+      primorials.len++;
+    }
+  while (end < table->len);
+
+  primorials.ends = (size_t *)malloc(primorials.len * sizeof(size_t));
+  primorials.products = gmpmee_array_alloc_init(primorials.len);
+
+  start = GMPMEE_TRIAL_GCD_HEAD;
+  for (i = 0; i < primorials.len; i++)
+    {
+      end = 2 * start < table->len ? 2 * start : table->len;
+      primorials.ends[i] = end;
+      range_product(primorials.products[i], table, start, end);
+      start = end;
+    }
+}
+
+const gmpmee_trial_primorials_struct *
+gmpmee_trial_primorials(void)
+{
+  pthread_once(&primorials_once, primorials_init);
+  return &primorials;
+}
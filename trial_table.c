@@ -0,0 +1,93 @@
+/*
+ * Copyright 2008 2009 2010 2011 2013 2014 2015 2016 Douglas Wikstrom
+ *
+ * This file is part of GMP Modular Exponentiation Extension (GMPMEE).
+ *
+ * GMPMEE is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * GMPMEE is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GMPMEE. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <gmp.h>
+#include "gmpmee.h"
+
+static gmpmee_trial_table_struct table;
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Returns the inverse of an odd integer modulo the word size. Each
+ * Newton iteration doubles the number of correct bits, starting with
+ * the three bits given by the integer itself.
+ */
+static unsigned long int
+inverse(unsigned long int p)
+{
+  unsigned long int x = p;
+  size_t bits;
+
+  for (bits = 3; bits < sizeof(unsigned long int) * CHAR_BIT; bits *= 2)
+    {
+      x *= 2 - p * x;
+    }
+  return x;
+}
+
+static void
+table_init(void)
+{
+  size_t i;
+  unsigned long int product;
+
+  table.primes = gmpmee_small_primes(&table.primes_len,
+				     GMPMEE_TRIAL_MAX_BOUND);
+  table.inverses = (unsigned long int *)
+    malloc(table.primes_len * sizeof(unsigned long int));
+  table.limits = (unsigned long int *)
+    malloc(table.primes_len * sizeof(unsigned long int));
+
+  for (i = 0; i < table.primes_len; i++)
+    {
+      table.inverses[i] = inverse(table.primes[i]);
+      table.limits[i] = ULONG_MAX / table.primes[i];
+    }
+
+  /* Each group holds at least one prime, so this is enough. */
+  table.products = (unsigned long int *)
+    malloc(table.primes_len * sizeof(unsigned long int));
+  table.starts = (size_t *)malloc((table.primes_len + 1) * sizeof(size_t));
+
+  /* Greedily form groups of consecutive primes. */
+  table.len = 0;
+  i = 0;
+  while (i < table.primes_len)
+    {
+      table.starts[table.len] = i;
+      product = 1;
+      while (i < table.primes_len && table.primes[i] <= ULONG_MAX / product)
+	{
+	  product *= table.primes[i];
+	  i++;
+	}
+      table.products[table.len++] = product;
+    }
+  table.starts[table.len] = table.primes_len;
+}
+
+const gmpmee_trial_table_struct *
+gmpmee_trial_table(void)
+{
+  pthread_once(&table_once, table_init);
+  return &table;
+}